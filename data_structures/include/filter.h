@@ -0,0 +1,60 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "utils.h"
+#include "dict.h"
+#include "set.h"
+
+// Approximate membership filters. may_include never returns false for
+// an entry that was added, and returns true for an entry that was not
+// added with probability about fp_rate.
+// Entries are hashed with the hash given at creation, so a filter built
+// from a set_t or dict_t uses the same hash as the set or dict.
+
+// Blocked Bloom filter: every entry sets its bits within a single
+// 64-byte block, so a lookup touches one cache line.
+// Entries cannot be removed.
+struct _impl_bloom_t;
+typedef struct _impl_bloom_t bloom_t;
+
+// Size the filter for n entries.
+bloom_t *bloom_create(size_t n, double fp_rate, size_t (*hash) (addr_t e));
+void bloom_destroy(bloom_t *F);
+
+void bloom_add(bloom_t *F, addr_t e);
+bool bloom_may_include(bloom_t *F, addr_t e);
+
+// Cuckoo filter: a fingerprint of each entry is kept in one of two
+// candidate buckets. Unlike a Bloom filter, entries can be removed.
+struct _impl_cuckoo_t;
+typedef struct _impl_cuckoo_t cuckoo_t;
+
+// Size the filter for n entries.
+cuckoo_t *cuckoo_create(size_t n, double fp_rate, size_t (*hash) (addr_t e));
+void cuckoo_destroy(cuckoo_t *F);
+
+// If the filter is too full to take e, return false.
+bool cuckoo_add(cuckoo_t *F, addr_t e);
+bool cuckoo_may_include(cuckoo_t *F, addr_t e);
+// Only remove entries that were added, or other entries may be lost.
+// If e was not found, return false.
+bool cuckoo_remove(cuckoo_t *F, addr_t e);
+
+// Front-ends for a set_t or dict_t, to answer negative lookups without
+// touching the table. Build the filter from S or D, and add entries
+// to it whenever they are added to S or D. Each entry is hashed once,
+// for both the filter and the table, so a filter made with bloom_create
+// or cuckoo_create must use the same hash as S or D.
+bloom_t *bloom_from_set(set_t *S, double fp_rate);
+bloom_t *bloom_from_dict(dict_t *D, double fp_rate);
+bool bloom_set_includes(bloom_t *F, set_t *S, addr_t e);
+addr_t bloom_dict_get(bloom_t *F, dict_t *D, addr_t k);
+
+// Grows the filter past n if some entries do not fit. If they still do
+// not fit, e.g. because too many entries share a hash, return NULL.
+cuckoo_t *cuckoo_from_set(set_t *S, double fp_rate);
+cuckoo_t *cuckoo_from_dict(dict_t *D, double fp_rate);
+bool cuckoo_set_includes(cuckoo_t *F, set_t *S, addr_t e);
+addr_t cuckoo_dict_get(cuckoo_t *F, dict_t *D, addr_t k);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+
+#include "utils.h"
+
+// Fast, well-distributed hash functions for use as the key_hash of a
+// dict_t or the hash of a set_t. Unlike identity-style hashes, every bit
+// of the input affects the low bits of the output, which are the bits
+// used to pick a bucket.
+
+// Finalizer for a 64-bit integer: a bijection with full avalanche.
+// Inline, since every hash table also uses it to pick a slot.
+static inline size_t hash_u64(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return (size_t) x;
+}
+// Combine two hashes, e.g. of the fields of a struct key.
+size_t hash_combine(size_t h1, size_t h2);
+
+// wyhash-style hash of an arbitrary byte buffer.
+// Inputs longer than HASH_LONG_LEN bytes are hashed in 64-byte stripes,
+// using SSE2/AVX2 when the compiler targets them.
+extern const size_t HASH_LONG_LEN;
+size_t hash_bytes(const void *data, size_t len, uint64_t seed);
+// Same result as hash_bytes, always computed without SIMD.
+size_t hash_bytes_portable(const void *data, size_t len, uint64_t seed);
+
+// Helpers shared by the hash tables.
+// Home slot of hash in a table of num_slots slots, a power of two.
+// Fibonacci hashing: one multiply spreads every bit of the hash into
+// the top bits of the product, which are the ones taken. So hashes
+// like int_hash that only differ in their high bits still spread,
+// without running hash_u64 again over hashes that already did.
+static inline size_t hash_slot(size_t hash, size_t num_slots) {
+  int log_2 = __builtin_ctzll(num_slots);
+  // Shift in two steps, since shifting by 64 when num_slots is 1
+  // is undefined.
+  return (size_t) ((((uint64_t) hash * 0x9e3779b97f4a7c15ull) >> (63 - log_2)) >> 1);
+}
+
+// For linear probing that deletes by shifting entries back: whether
+// the entry at slot j, whose home slot is h, may move back to slot i.
+static inline bool hash_slot_can_shift(size_t i, size_t j, size_t h) {
+  if (i <= j) {
+    return h <= i || h > j;
+  } else {
+    return h <= i && h > j;
+  }
+}
+
+// Hashes that can be passed directly to dict_create/set_create.
+// Key is an int *, e.g. from int_wrap.
+size_t hash_int(addr_t e);
+// Key is compared by address.
+size_t hash_ptr(addr_t e);
+// Key is a boxed str_t, e.g. from str_wrap.
+size_t hash_str(addr_t e);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "utils.h"
+#include "str.h"
+
+// Table of canonical strings: interning two strings with the same
+// contents returns the same pointer, so interned strings can be
+// compared by address, and their hash is computed once, when they
+// are first interned. Interned strings are owned by the table, must
+// not be changed, and stay valid until it is destroyed.
+struct _impl_intern_t;
+typedef struct _impl_intern_t intern_t;
+
+intern_t *intern_create();
+void intern_destroy(intern_t *T);
+
+size_t intern_len(intern_t *T);
+// Return the canonical copy of s, adding one if there is none.
+// The caller keeps ownership of s.
+str_t intern_str(intern_t *T, str_t s);
+// Same as intern_str, without needing a \0-terminated string,
+// e.g. for the tokens of a str_split_iter_t.
+str_t intern_view(intern_t *T, str_view_t V);
+// If V was never interned, return NULL.
+str_t intern_get(intern_t *T, str_view_t V);
+
+// For keying a dict_t or set_t by interned strings.
+bool intern_eq(addr_t s1, addr_t s2);
+size_t intern_hash(addr_t s);
+size_t intern_str_len(addr_t s);
+
+struct _impl_intern_stats_t {
+  // Number of distinct strings.
+  size_t len;
+  // Bytes held by the strings, including their headers.
+  size_t num_bytes;
+  // Number of intern_str/intern_view calls that found a copy.
+  size_t num_hits;
+  // Bytes those calls would have taken as separate copies.
+  size_t num_bytes_saved;
+};
+typedef struct _impl_intern_stats_t intern_stats_t;
+
+void intern_stats(intern_t *T, intern_stats_t *stats);
+
+#endif
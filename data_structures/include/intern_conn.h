@@ -0,0 +1,24 @@
+#ifndef INTERN_CONN_H
+#define INTERN_CONN_H
+
+#include "utils.h"
+#include "str.h"
+#include "intern.h"
+
+struct _impl_intern_conn_t;
+typedef struct _impl_intern_conn_t intern_conn_t;
+
+intern_conn_t *intern_conn_create(intern_t *T);
+void intern_conn_destroy(intern_conn_t *TC);
+
+// Thread-safe read functions
+size_t intern_conn_len(intern_conn_t *TC);
+str_t intern_conn_get(intern_conn_t *TC, str_view_t V);
+void intern_conn_stats(intern_conn_t *TC, intern_stats_t *stats);
+
+// Thread-safe write functions
+// Strings that are already interned only take the read lock.
+str_t intern_conn_str(intern_conn_t *TC, str_t s);
+str_t intern_conn_view(intern_conn_t *TC, str_view_t V);
+
+#endif
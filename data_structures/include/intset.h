@@ -0,0 +1,68 @@
+#ifndef INTSET_H
+#define INTSET_H
+
+#include <stdint.h>
+
+#include "utils.h"
+#include "list.h"
+#include "set.h"
+
+// Sets of non-negative integers, stored as bits rather than as
+// int_wrap'd entries of a set_t.
+// Conversions from a set_t or list_t expect entries that are int *,
+// e.g. from int_wrap, and conversions to a list_t allocate a fresh
+// int * for each entry, for the caller to free. Since entries are int,
+// conversions only cover entries up to INT_MAX, and converting a set
+// with a larger entry to a list_t is an error.
+
+// Bitset: one bit for every integer below the largest entry,
+// for dense ranges. Grows as needed.
+struct _impl_bitset_t;
+typedef struct _impl_bitset_t bitset_t;
+
+// Reserve room for entries below n.
+bitset_t *bitset_create(size_t n);
+void bitset_destroy(bitset_t *B);
+
+size_t bitset_len(bitset_t *B);
+bool bitset_includes(bitset_t *B, size_t e);
+void bitset_add(bitset_t *B, size_t e);
+// Return whether e was in B.
+bool bitset_remove(bitset_t *B, size_t e);
+
+// In-place set algebra, using SSE2/AVX2 when the compiler targets them.
+// C is left untouched.
+void bitset_union_into(bitset_t *B, bitset_t *C);
+void bitset_intersect_inplace(bitset_t *B, bitset_t *C);
+void bitset_difference_inplace(bitset_t *B, bitset_t *C);
+
+// Entries in increasing order.
+list_t *bitset_to_list(bitset_t *B);
+bitset_t *bitset_from_list(list_t *L);
+bitset_t *bitset_from_set(set_t *S);
+
+// Roaring bitmap: entries are split by their high 16 bits into
+// containers, each of which is either a sorted array of the low 16 bits
+// when sparse, or a 2^16-bit bitset when dense. Entries are 32-bit.
+struct _impl_roaring_t;
+typedef struct _impl_roaring_t roaring_t;
+
+roaring_t *roaring_create();
+void roaring_destroy(roaring_t *R);
+
+size_t roaring_len(roaring_t *R);
+bool roaring_includes(roaring_t *R, uint32_t e);
+void roaring_add(roaring_t *R, uint32_t e);
+// Return whether e was in R.
+bool roaring_remove(roaring_t *R, uint32_t e);
+
+roaring_t *roaring_union(roaring_t *R1, roaring_t *R2);
+roaring_t *roaring_intersection(roaring_t *R1, roaring_t *R2);
+roaring_t *roaring_difference(roaring_t *R1, roaring_t *R2);
+
+// Entries in increasing order.
+list_t *roaring_to_list(roaring_t *R);
+roaring_t *roaring_from_list(list_t *L);
+roaring_t *roaring_from_set(set_t *S);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef ITER_H
+#define ITER_H
+
+#include "utils.h"
+#include "list.h"
+#include "dict.h"
+#include "set.h"
+
+// Lazy, pull-based pipeline over a sequence of entries.
+// Each stage is owned by the caller (typically on the stack) and only
+// pulls from its source when asked, so a chain of map/filter/take/zip
+// runs as a single fused pass. Nothing is allocated until a terminal
+// operation such as iter_collect.
+struct _impl_iter_t {
+  bool (*next)(struct _impl_iter_t *It, addr_t *e);
+  struct _impl_iter_t *src;
+  struct _impl_iter_t *other;
+  list_t *L;
+  dict_iter_t DI;
+  set_iter_t SI;
+  size_t index;
+  size_t remaining;
+  addr_t (*map)(addr_t e);
+  bool (*filter)(addr_t e);
+  addr_t (*zip)(addr_t e1, addr_t e2);
+};
+typedef struct _impl_iter_t iter_t;
+
+// Sources
+void iter_from_list(iter_t *It, list_t *L);
+// Walk the table in place rather than going through
+// dict_items/dict_keys/dict_values/set_to_list.
+void iter_from_dict_items(iter_t *It, dict_t *D);
+void iter_from_dict_keys(iter_t *It, dict_t *D);
+void iter_from_dict_values(iter_t *It, dict_t *D);
+void iter_from_set(iter_t *It, set_t *S);
+
+// Stages
+void iter_map(iter_t *It, iter_t *src, addr_t (*map)(addr_t e));
+void iter_filter(iter_t *It, iter_t *src, bool (*filter)(addr_t e));
+void iter_take(iter_t *It, iter_t *src, size_t n);
+// Stops when either source is exhausted.
+void iter_zip(iter_t *It, iter_t *src1, iter_t *src2, addr_t (*zip)(addr_t e1, addr_t e2));
+// Lazy counterpart of list_concat.
+void iter_chain(iter_t *It, iter_t *src1, iter_t *src2);
+
+// If there are no entries left, return false and leave e untouched.
+bool iter_next(iter_t *It, addr_t *e);
+
+// Terminal operations, each of which consumes the pipeline.
+list_t *iter_collect(iter_t *It);
+void iter_for_each(iter_t *It, void (*action)(addr_t e));
+void iter_reduce(iter_t *It, void (*combine)(addr_t acc, addr_t e), addr_t acc);
+
+#endif
@@ -4,6 +4,8 @@
 #include "utils.h"
 #include "list.h"
 
+// Hash set that stores only its entries, with O(1) add/remove/includes.
+// Entries must not be NULL.
 struct _impl_set_t;
 typedef struct _impl_set_t set_t;
 
@@ -14,9 +16,43 @@ addr_t set_key_eq(set_t *S);
 addr_t set_hash(set_t *S);
 size_t set_len(set_t *S);
 bool set_includes(set_t *S, addr_t e);
+// Same as set_includes, for a hash of e already computed by the hash
+// of S, e.g. by a filter in front of S, so that e is only hashed once.
+bool set_includes_hashed(set_t *S, addr_t e, size_t hash);
 list_t *set_to_list(set_t *S);
 
+// Cursor over the entries of a set_t that walks the table in place
+// without allocating. S must not be modified while iterating.
+struct _impl_set_iter_t {
+  struct _impl_set_t *S;
+  size_t index;
+  addr_t e;
+};
+typedef struct _impl_set_iter_t set_iter_t;
+
+void set_iter_init(set_iter_t *It, set_t *S);
+// Advance to the next entry. If there are none left, return false.
+bool set_iter_next(set_iter_t *It);
+addr_t set_iter_entry(set_iter_t *It);
+
+// If e is in S, return the entry of S equal to it, else NULL.
+addr_t set_get(set_t *S, addr_t e);
 void set_add(set_t *S, addr_t e);
 addr_t set_remove(set_t *S, addr_t e);
 
+// Make room for n entries, so that adding up to n entries never resizes.
+void set_reserve(set_t *S, size_t n);
+
+// In-place set algebra. S and T must share a hash function,
+// and T is left untouched.
+// Add every entry of T to S, resizing S at most once.
+void set_union_into(set_t *S, set_t *T);
+// Remove the entries of S that are not in T,
+// probing whichever of S and T is larger.
+void set_intersect_inplace(set_t *S, set_t *T);
+// Batch variant of set_includes that hashes each entry exactly once.
+// Like dict_get_many, return a list with the result for each entry:
+// the entry of S equal to it, as set_get, or NULL where it is not in S.
+list_t *set_includes_many(set_t *S, list_t *entries);
+
 #endif
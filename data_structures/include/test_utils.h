@@ -4,12 +4,17 @@
 #include "utils.h"
 #include "str.h"
 #include "list.h"
+#include "snapshot.h"
 
 addr_t int_wrap(int i);
 int int_unwrap(addr_t e);
 str_t int_str(addr_t e);
 void int_sum(addr_t acc, addr_t e);
 addr_t int_double(addr_t i);
+bool int_is_even(addr_t e);
+addr_t int_add(addr_t e1, addr_t e2);
+// Treats NULL as 0.
+addr_t int_increment(addr_t e);
 bool int_eq(addr_t e1, addr_t e2);
 size_t int_hash(addr_t e);
 int int_compare(addr_t e1, addr_t e2);
@@ -17,6 +22,15 @@ int int_compare(addr_t e1, addr_t e2);
 str_t str_str(addr_t e);
 void str_destroy(addr_t e);
 
+// Snapshot codecs for wrapped ints and for strings,
+// whose decoded entries are freed with memory_free.
+void int_encode(addr_t e, str_buf_t *out);
+addr_t int_decode(str_view_t bytes);
+void str_encode(addr_t e, str_buf_t *out);
+addr_t str_decode(str_view_t bytes);
+extern snapshot_codec_t INT_CODEC;
+extern snapshot_codec_t STR_CODEC;
+
 struct _piece_t {
   char first;
   int second;
@@ -0,0 +1,413 @@
+#ifndef TYPED_H
+#define TYPED_H
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "utils.h"
+#include "hash.h"
+#include "memory.h"
+
+/* Typed containers that store their entries inline.
+ *
+ * list_t, dict_t and set_t store addr_t, so a container of ints has to
+ * heap-allocate every element (see int_wrap). The generator macros below
+ * instead define a container for one concrete type, with entries stored
+ * directly in its arrays and the hash/compare functions inlined.
+ *
+ *   LIST_DEFINE(int_list, int)
+ *   DICT_DEFINE(u64_double_dict, uint64_t, double, typed_hash_u64, typed_eq_u64)
+ *   SET_DEFINE(int_set, int, typed_hash_int, typed_eq_int)
+ *
+ * Each macro defines name_t along with name_create, name_destroy, etc.
+ * key_hash and key_eq take keys by value:
+ *   size_t key_hash(K k);
+ *   bool key_eq(K k1, K k2);
+ * Slots are picked from the low bits of key_hash directly, so it should
+ * mix every bit of the key into them, as typed_hash_u64 does.
+ *
+ * The dict and set are open-addressed with linear probing, and remove
+ * entries by shifting later ones back so that no tombstones are left.
+ */
+
+static inline size_t typed_hash_u64(uint64_t k) {
+  return hash_u64(k);
+}
+
+static inline size_t typed_hash_int(int k) {
+  return typed_hash_u64((uint64_t) (int64_t) k);
+}
+
+static inline bool typed_eq_u64(uint64_t k1, uint64_t k2) {
+  return k1 == k2;
+}
+
+static inline bool typed_eq_int(int k1, int k2) {
+  return k1 == k2;
+}
+
+// Capacity is a power of two, and the table grows past 3/4 full.
+static inline bool _typed_needs_grow(size_t len, size_t capacity) {
+  return (len + 1) * 4 > capacity * 3;
+}
+
+static inline size_t _typed_grow_capacity(size_t capacity) {
+  return capacity == 0 ? 8 : capacity * 2;
+}
+
+#define LIST_DEFINE(name, T) \
+typedef struct { \
+  size_t len; \
+  /* If len == 0, capacity == 0. */ \
+  /* Else, capacity / 2 < len <= capacity. */ \
+  size_t capacity; \
+  T *arr; \
+} name##_t; \
+\
+static inline void _##name##_resize(name##_t *L, size_t new_len) { \
+  if (new_len == 0) { \
+    if (L->arr != NULL) { \
+      memory_free(L->arr); \
+    } \
+    L->len = 0; \
+    L->capacity = 0; \
+    L->arr = NULL; \
+    return; \
+  } \
+  if (L->capacity / 2 < new_len && new_len <= L->capacity) { \
+    L->len = new_len; \
+    return; \
+  } \
+  size_t new_capacity = L->capacity == 0 ? 1 : L->capacity; \
+  while (new_capacity < new_len) { \
+    new_capacity *= 2; \
+  } \
+  while (new_capacity >= 2 * new_len) { \
+    new_capacity /= 2; \
+  } \
+  T *arr = (T *) memory_calloc(new_capacity, sizeof(T)); \
+  if (L->arr != NULL) { \
+    size_t copy_len = L->len < new_len ? L->len : new_len; \
+    memcpy(arr, L->arr, copy_len * sizeof(T)); \
+    memory_free(L->arr); \
+  } \
+  L->len = new_len; \
+  L->capacity = new_capacity; \
+  L->arr = arr; \
+} \
+\
+static inline name##_t *name##_create(size_t len) { \
+  name##_t *L = (name##_t *) memory_malloc(sizeof(name##_t)); \
+  L->len = 0; \
+  L->capacity = 0; \
+  L->arr = NULL; \
+  _##name##_resize(L, len); \
+  return L; \
+} \
+\
+static inline void name##_destroy(name##_t *L) { \
+  if (L->arr != NULL) { \
+    memory_free(L->arr); \
+  } \
+  memory_free(L); \
+} \
+\
+static inline size_t name##_len(name##_t *L) { \
+  return L->len; \
+} \
+\
+static inline T name##_get(name##_t *L, size_t i) { \
+  assert(i < L->len); \
+  return L->arr[i]; \
+} \
+\
+static inline void name##_set(name##_t *L, size_t i, T e) { \
+  assert(i < L->len); \
+  L->arr[i] = e; \
+} \
+\
+static inline void name##_push(name##_t *L, T e) { \
+  _##name##_resize(L, L->len + 1); \
+  L->arr[L->len - 1] = e; \
+} \
+\
+static inline T name##_pop(name##_t *L) { \
+  assert(L->len > 0); \
+  T e = L->arr[L->len - 1]; \
+  _##name##_resize(L, L->len - 1); \
+  return e; \
+}
+
+#define DICT_DEFINE(name, K, V, key_hash, key_eq) \
+typedef struct { \
+  K key; \
+  V value; \
+} name##_entry_t; \
+\
+typedef struct { \
+  size_t len; \
+  size_t capacity; \
+  name##_entry_t *entries; \
+  /* used[i] is 1 if entries[i] holds a key. */ \
+  uint8_t *used; \
+} name##_t; \
+\
+static inline size_t _##name##_home(name##_t *D, K k) { \
+  return key_hash(k) & (D->capacity - 1); \
+} \
+\
+/* If k is in D, set *slot to it and return true. */ \
+/* Else, set *slot to where k would be inserted. */ \
+static inline bool _##name##_find(name##_t *D, K k, size_t *slot) { \
+  size_t mask = D->capacity - 1; \
+  size_t i = _##name##_home(D, k); \
+  while (D->used[i]) { \
+    if (key_eq(D->entries[i].key, k)) { \
+      *slot = i; \
+      return true; \
+    } \
+    i = (i + 1) & mask; \
+  } \
+  *slot = i; \
+  return false; \
+} \
+\
+static inline void _##name##_grow(name##_t *D) { \
+  name##_entry_t *entries = D->entries; \
+  uint8_t *used = D->used; \
+  size_t capacity = D->capacity; \
+\
+  D->capacity = _typed_grow_capacity(capacity); \
+  D->entries = (name##_entry_t *) memory_calloc(D->capacity, sizeof(name##_entry_t)); \
+  D->used = (uint8_t *) memory_calloc(D->capacity, sizeof(uint8_t)); \
+\
+  size_t slot; \
+  for (size_t i = 0; i < capacity; i++) { \
+    if (used[i]) { \
+      _##name##_find(D, entries[i].key, &slot); \
+      D->entries[slot] = entries[i]; \
+      D->used[slot] = 1; \
+    } \
+  } \
+  if (capacity > 0) { \
+    memory_free(entries); \
+    memory_free(used); \
+  } \
+} \
+\
+static inline name##_t *name##_create() { \
+  name##_t *D = (name##_t *) memory_malloc(sizeof(name##_t)); \
+  D->len = 0; \
+  D->capacity = 0; \
+  D->entries = NULL; \
+  D->used = NULL; \
+  return D; \
+} \
+\
+static inline void name##_destroy(name##_t *D) { \
+  if (D->capacity > 0) { \
+    memory_free(D->entries); \
+    memory_free(D->used); \
+  } \
+  memory_free(D); \
+} \
+\
+static inline size_t name##_len(name##_t *D) { \
+  return D->len; \
+} \
+\
+/* If k does not exist in D, return false. */ \
+static inline bool name##_get(name##_t *D, K k, V *v) { \
+  size_t slot; \
+  if (D->len == 0 || !_##name##_find(D, k, &slot)) { \
+    return false; \
+  } \
+  *v = D->entries[slot].value; \
+  return true; \
+} \
+\
+/* If k does not exist in D, first set it to v. */ \
+/* The pointer is valid until D is next modified. */ \
+static inline V *name##_get_or_insert(name##_t *D, K k, V v) { \
+  if (_typed_needs_grow(D->len, D->capacity)) { \
+    _##name##_grow(D); \
+  } \
+  size_t slot; \
+  if (!_##name##_find(D, k, &slot)) { \
+    D->entries[slot].key = k; \
+    D->entries[slot].value = v; \
+    D->used[slot] = 1; \
+    D->len++; \
+  } \
+  return &D->entries[slot].value; \
+} \
+\
+static inline void name##_set(name##_t *D, K k, V v) { \
+  *name##_get_or_insert(D, k, v) = v; \
+} \
+\
+/* If k does not exist in D, return false. */ \
+static inline bool name##_del(name##_t *D, K k, V *v) { \
+  size_t i; \
+  if (D->len == 0 || !_##name##_find(D, k, &i)) { \
+    return false; \
+  } \
+  if (v != NULL) { \
+    *v = D->entries[i].value; \
+  } \
+  size_t mask = D->capacity - 1; \
+  size_t j = i; \
+  while (true) { \
+    j = (j + 1) & mask; \
+    if (!D->used[j]) { \
+      break; \
+    } \
+    if (hash_slot_can_shift(i, j, _##name##_home(D, D->entries[j].key))) { \
+      D->entries[i] = D->entries[j]; \
+      i = j; \
+    } \
+  } \
+  D->used[i] = 0; \
+  D->len--; \
+  return true; \
+} \
+\
+/* Iterate with a cursor starting at 0. */ \
+/* If there are no entries left, return false. */ \
+static inline bool name##_next(name##_t *D, size_t *cursor, K *k, V *v) { \
+  for (; *cursor < D->capacity; (*cursor)++) { \
+    if (D->used[*cursor]) { \
+      *k = D->entries[*cursor].key; \
+      *v = D->entries[*cursor].value; \
+      (*cursor)++; \
+      return true; \
+    } \
+  } \
+  return false; \
+}
+
+#define SET_DEFINE(name, T, hash, entry_eq) \
+typedef struct { \
+  size_t len; \
+  size_t capacity; \
+  T *entries; \
+  /* used[i] is 1 if entries[i] holds an entry. */ \
+  uint8_t *used; \
+} name##_t; \
+\
+static inline size_t _##name##_home(name##_t *S, T e) { \
+  return hash(e) & (S->capacity - 1); \
+} \
+\
+static inline bool _##name##_find(name##_t *S, T e, size_t *slot) { \
+  size_t mask = S->capacity - 1; \
+  size_t i = _##name##_home(S, e); \
+  while (S->used[i]) { \
+    if (entry_eq(S->entries[i], e)) { \
+      *slot = i; \
+      return true; \
+    } \
+    i = (i + 1) & mask; \
+  } \
+  *slot = i; \
+  return false; \
+} \
+\
+static inline void _##name##_grow(name##_t *S) { \
+  T *entries = S->entries; \
+  uint8_t *used = S->used; \
+  size_t capacity = S->capacity; \
+\
+  S->capacity = _typed_grow_capacity(capacity); \
+  S->entries = (T *) memory_calloc(S->capacity, sizeof(T)); \
+  S->used = (uint8_t *) memory_calloc(S->capacity, sizeof(uint8_t)); \
+\
+  size_t slot; \
+  for (size_t i = 0; i < capacity; i++) { \
+    if (used[i]) { \
+      _##name##_find(S, entries[i], &slot); \
+      S->entries[slot] = entries[i]; \
+      S->used[slot] = 1; \
+    } \
+  } \
+  if (capacity > 0) { \
+    memory_free(entries); \
+    memory_free(used); \
+  } \
+} \
+\
+static inline name##_t *name##_create() { \
+  name##_t *S = (name##_t *) memory_malloc(sizeof(name##_t)); \
+  S->len = 0; \
+  S->capacity = 0; \
+  S->entries = NULL; \
+  S->used = NULL; \
+  return S; \
+} \
+\
+static inline void name##_destroy(name##_t *S) { \
+  if (S->capacity > 0) { \
+    memory_free(S->entries); \
+    memory_free(S->used); \
+  } \
+  memory_free(S); \
+} \
+\
+static inline size_t name##_len(name##_t *S) { \
+  return S->len; \
+} \
+\
+static inline bool name##_includes(name##_t *S, T e) { \
+  size_t slot; \
+  return S->len > 0 && _##name##_find(S, e, &slot); \
+} \
+\
+static inline void name##_add(name##_t *S, T e) { \
+  if (_typed_needs_grow(S->len, S->capacity)) { \
+    _##name##_grow(S); \
+  } \
+  size_t slot; \
+  if (!_##name##_find(S, e, &slot)) { \
+    S->entries[slot] = e; \
+    S->used[slot] = 1; \
+    S->len++; \
+  } \
+} \
+\
+/* If e does not exist in S, return false. */ \
+static inline bool name##_remove(name##_t *S, T e) { \
+  size_t i; \
+  if (S->len == 0 || !_##name##_find(S, e, &i)) { \
+    return false; \
+  } \
+  size_t mask = S->capacity - 1; \
+  size_t j = i; \
+  while (true) { \
+    j = (j + 1) & mask; \
+    if (!S->used[j]) { \
+      break; \
+    } \
+    if (hash_slot_can_shift(i, j, _##name##_home(S, S->entries[j]))) { \
+      S->entries[i] = S->entries[j]; \
+      i = j; \
+    } \
+  } \
+  S->used[i] = 0; \
+  S->len--; \
+  return true; \
+} \
+\
+/* Iterate with a cursor starting at 0. */ \
+/* If there are no entries left, return false. */ \
+static inline bool name##_next(name##_t *S, size_t *cursor, T *e) { \
+  for (; *cursor < S->capacity; (*cursor)++) { \
+    if (S->used[*cursor]) { \
+      *e = S->entries[*cursor]; \
+      (*cursor)++; \
+      return true; \
+    } \
+  } \
+  return false; \
+}
+
+#endif
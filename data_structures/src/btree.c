@@ -0,0 +1,537 @@
+#include <assert.h>
+
+#include "../include/item.h"
+#include "../include/memory.h"
+#include "../include/btree.h"
+
+/* Nodes hold up to BTREE_MAX_KEYS keys, so that the keys of a node,
+ * which are what a lookup scans, fill two 64-byte cache lines.
+ * Every node but the root holds at least BTREE_MIN_KEYS keys.
+ */
+#define BTREE_MAX_KEYS 16
+#define BTREE_MIN_KEYS (BTREE_MAX_KEYS / 2)
+
+struct _btree_node {
+  bool is_leaf;
+  size_t len;
+  addr_t keys[BTREE_MAX_KEYS];
+  union {
+    // Leaves: values[i] is the value at keys[i].
+    addr_t values[BTREE_MAX_KEYS];
+    // Internal nodes: every key of children[i] is < keys[i],
+    // and every key of children[i + 1] is >= keys[i].
+    struct _btree_node *children[BTREE_MAX_KEYS + 1];
+  };
+  // Leaves are linked in order, for iteration.
+  struct _btree_node *next;
+};
+typedef struct _btree_node node;
+
+/* As with list_sort, compare(k1, k2) > 0 means k1 comes before k2,
+ * and "<" below means "comes before".
+ */
+struct _impl_btree_t {
+  size_t len;
+  node *root;
+  int (*compare)(addr_t k1, addr_t k2);
+};
+
+node *_node_create(bool is_leaf) {
+  node *N = (node *) memory_malloc(sizeof(node));
+  N->is_leaf = is_leaf;
+  N->len = 0;
+  N->next = NULL;
+  return N;
+}
+
+void _node_destroy(node *N, void (*key_destroy)(addr_t k), void (*value_destroy)(addr_t v)) {
+  if (N->is_leaf) {
+    for (size_t i = 0; i < N->len; i++) {
+      if (key_destroy != NULL) {
+        key_destroy(N->keys[i]);
+      }
+      if (value_destroy != NULL) {
+        value_destroy(N->values[i]);
+      }
+    }
+  } else {
+    for (size_t i = 0; i <= N->len; i++) {
+      _node_destroy(N->children[i], key_destroy, value_destroy);
+    }
+  }
+  memory_free(N);
+}
+
+// First index i with keys[i] >= k.
+size_t _node_lower(btree_t *T, node *N, addr_t k) {
+  size_t lo = 0;
+  size_t hi = N->len;
+  size_t mid;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (T->compare(N->keys[mid], k) > 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// First index i with keys[i] > k.
+size_t _node_upper(btree_t *T, node *N, addr_t k) {
+  size_t lo = 0;
+  size_t hi = N->len;
+  size_t mid;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (T->compare(N->keys[mid], k) >= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// The leaf whose range holds k.
+node *_btree_leaf(btree_t *T, addr_t k) {
+  node *N = T->root;
+  while (!N->is_leaf) {
+    N = N->children[_node_upper(T, N, k)];
+  }
+  return N;
+}
+
+btree_t *btree_create(int (*compare)(addr_t k1, addr_t k2)) {
+  btree_t *T = (btree_t *) memory_malloc(sizeof(btree_t));
+
+  T->len = 0;
+  T->root = _node_create(true);
+  T->compare = compare;
+
+  return T;
+}
+
+void btree_destroy(btree_t *T) {
+  assert(T);
+
+  _node_destroy(T->root, NULL, NULL);
+  memory_free(T);
+}
+
+void btree_total_destroy(btree_t *T, void (*key_destroy)(addr_t k), void (*value_destroy)(addr_t v)) {
+  assert(T);
+
+  _node_destroy(T->root, key_destroy, value_destroy);
+  memory_free(T);
+}
+
+size_t btree_len(btree_t *T) {
+  assert(T);
+
+  return T->len;
+}
+
+addr_t btree_get(btree_t *T, addr_t k) {
+  assert(T);
+
+  node *L = _btree_leaf(T, k);
+  size_t i = _node_lower(T, L, k);
+  if (i < L->len && T->compare(L->keys[i], k) == 0) {
+    return L->values[i];
+  }
+  return NULL;
+}
+
+/* Insert (k, v) into the full leaf L at position i,
+ * splitting it in two. Return the new right half.
+ */
+node *_leaf_split_insert(node *L, size_t i, addr_t k, addr_t v) {
+  addr_t keys[BTREE_MAX_KEYS + 1];
+  addr_t values[BTREE_MAX_KEYS + 1];
+  for (size_t j = 0, s = 0; j <= BTREE_MAX_KEYS; j++) {
+    if (j == i) {
+      keys[j] = k;
+      values[j] = v;
+    } else {
+      keys[j] = L->keys[s];
+      values[j] = L->values[s];
+      s++;
+    }
+  }
+
+  node *R = _node_create(true);
+  size_t mid = (BTREE_MAX_KEYS + 1) / 2;
+  for (size_t j = 0; j < mid; j++) {
+    L->keys[j] = keys[j];
+    L->values[j] = values[j];
+  }
+  L->len = mid;
+  for (size_t j = mid; j <= BTREE_MAX_KEYS; j++) {
+    R->keys[j - mid] = keys[j];
+    R->values[j - mid] = values[j];
+  }
+  R->len = BTREE_MAX_KEYS + 1 - mid;
+
+  R->next = L->next;
+  L->next = R;
+  return R;
+}
+
+/* Insert separator k and its right child C into the full internal
+ * node N at position i, splitting it in two.
+ * Return the new right half, and set *sep to the key that moves up.
+ */
+node *_internal_split_insert(node *N, size_t i, addr_t k, node *C, addr_t *sep) {
+  addr_t keys[BTREE_MAX_KEYS + 1];
+  node *children[BTREE_MAX_KEYS + 2];
+  children[0] = N->children[0];
+  for (size_t j = 0, s = 0; j <= BTREE_MAX_KEYS; j++) {
+    if (j == i) {
+      keys[j] = k;
+      children[j + 1] = C;
+    } else {
+      keys[j] = N->keys[s];
+      children[j + 1] = N->children[s + 1];
+      s++;
+    }
+  }
+
+  node *R = _node_create(false);
+  size_t mid = BTREE_MAX_KEYS / 2;
+  for (size_t j = 0; j < mid; j++) {
+    N->keys[j] = keys[j];
+    N->children[j] = children[j];
+  }
+  N->children[mid] = children[mid];
+  N->len = mid;
+
+  *sep = keys[mid];
+
+  for (size_t j = mid + 1; j <= BTREE_MAX_KEYS; j++) {
+    R->keys[j - mid - 1] = keys[j];
+    R->children[j - mid - 1] = children[j];
+  }
+  R->children[BTREE_MAX_KEYS - mid] = children[BTREE_MAX_KEYS + 1];
+  R->len = BTREE_MAX_KEYS - mid;
+  return R;
+}
+
+/* Insert (k, v) into the subtree at N.
+ * If N splits, return its new right sibling and set *sep to the
+ * separator between them; otherwise return NULL.
+ */
+node *_btree_insert(btree_t *T, node *N, addr_t k, addr_t v, addr_t *sep, bool *inserted) {
+  if (N->is_leaf) {
+    size_t i = _node_lower(T, N, k);
+    if (i < N->len && T->compare(N->keys[i], k) == 0) {
+      N->values[i] = v;
+      *inserted = false;
+      return NULL;
+    }
+    *inserted = true;
+
+    if (N->len == BTREE_MAX_KEYS) {
+      node *R = _leaf_split_insert(N, i, k, v);
+      *sep = R->keys[0];
+      return R;
+    }
+    for (size_t j = N->len; j > i; j--) {
+      N->keys[j] = N->keys[j - 1];
+      N->values[j] = N->values[j - 1];
+    }
+    N->keys[i] = k;
+    N->values[i] = v;
+    N->len++;
+    return NULL;
+  }
+
+  size_t i = _node_upper(T, N, k);
+  addr_t child_sep;
+  node *C = _btree_insert(T, N->children[i], k, v, &child_sep, inserted);
+  if (C == NULL) {
+    return NULL;
+  }
+
+  if (N->len == BTREE_MAX_KEYS) {
+    return _internal_split_insert(N, i, child_sep, C, sep);
+  }
+  for (size_t j = N->len; j > i; j--) {
+    N->keys[j] = N->keys[j - 1];
+    N->children[j + 1] = N->children[j];
+  }
+  N->keys[i] = child_sep;
+  N->children[i + 1] = C;
+  N->len++;
+  return NULL;
+}
+
+void btree_set(btree_t *T, addr_t k, addr_t v) {
+  assert(T);
+
+  addr_t sep;
+  bool inserted;
+  node *R = _btree_insert(T, T->root, k, v, &sep, &inserted);
+  if (R != NULL) {
+    node *root = _node_create(false);
+    root->keys[0] = sep;
+    root->children[0] = T->root;
+    root->children[1] = R;
+    root->len = 1;
+    T->root = root;
+  }
+  if (inserted) {
+    T->len++;
+  }
+}
+
+// Merge children[i + 1] of N into children[i].
+void _btree_merge(node *N, size_t i) {
+  node *L = N->children[i];
+  node *R = N->children[i + 1];
+
+  if (L->is_leaf) {
+    for (size_t j = 0; j < R->len; j++) {
+      L->keys[L->len + j] = R->keys[j];
+      L->values[L->len + j] = R->values[j];
+    }
+    L->len += R->len;
+    L->next = R->next;
+  } else {
+    L->keys[L->len] = N->keys[i];
+    for (size_t j = 0; j < R->len; j++) {
+      L->keys[L->len + 1 + j] = R->keys[j];
+      L->children[L->len + 1 + j] = R->children[j];
+    }
+    L->children[L->len + 1 + R->len] = R->children[R->len];
+    L->len += R->len + 1;
+  }
+  memory_free(R);
+
+  for (size_t j = i; j + 1 < N->len; j++) {
+    N->keys[j] = N->keys[j + 1];
+    N->children[j + 1] = N->children[j + 2];
+  }
+  N->len--;
+}
+
+// Move the last key of children[i - 1] of N to the front of children[i].
+void _btree_borrow_left(node *N, size_t i) {
+  node *L = N->children[i - 1];
+  node *C = N->children[i];
+
+  if (C->is_leaf) {
+    for (size_t j = C->len; j > 0; j--) {
+      C->keys[j] = C->keys[j - 1];
+      C->values[j] = C->values[j - 1];
+    }
+    C->keys[0] = L->keys[L->len - 1];
+    C->values[0] = L->values[L->len - 1];
+    N->keys[i - 1] = C->keys[0];
+  } else {
+    C->children[C->len + 1] = C->children[C->len];
+    for (size_t j = C->len; j > 0; j--) {
+      C->keys[j] = C->keys[j - 1];
+      C->children[j] = C->children[j - 1];
+    }
+    C->keys[0] = N->keys[i - 1];
+    C->children[0] = L->children[L->len];
+    N->keys[i - 1] = L->keys[L->len - 1];
+  }
+  C->len++;
+  L->len--;
+}
+
+// Move the first key of children[i + 1] of N to the end of children[i].
+void _btree_borrow_right(node *N, size_t i) {
+  node *C = N->children[i];
+  node *R = N->children[i + 1];
+
+  if (C->is_leaf) {
+    C->keys[C->len] = R->keys[0];
+    C->values[C->len] = R->values[0];
+    for (size_t j = 0; j + 1 < R->len; j++) {
+      R->keys[j] = R->keys[j + 1];
+      R->values[j] = R->values[j + 1];
+    }
+    N->keys[i] = R->keys[0];
+  } else {
+    C->keys[C->len] = N->keys[i];
+    C->children[C->len + 1] = R->children[0];
+    N->keys[i] = R->keys[0];
+    for (size_t j = 0; j + 1 < R->len; j++) {
+      R->keys[j] = R->keys[j + 1];
+      R->children[j] = R->children[j + 1];
+    }
+    R->children[R->len - 1] = R->children[R->len];
+  }
+  C->len++;
+  R->len--;
+}
+
+// Bring children[i] of N, which just fell below BTREE_MIN_KEYS,
+// back up by borrowing from or merging with a sibling.
+void _btree_fix(node *N, size_t i) {
+  if (i > 0 && N->children[i - 1]->len > BTREE_MIN_KEYS) {
+    _btree_borrow_left(N, i);
+  } else if (i < N->len && N->children[i + 1]->len > BTREE_MIN_KEYS) {
+    _btree_borrow_right(N, i);
+  } else if (i > 0) {
+    _btree_merge(N, i - 1);
+  } else {
+    _btree_merge(N, i);
+  }
+}
+
+// Remove k from the subtree at N, setting *rk and *rv to the stored
+// key and value. If k does not exist, return false.
+bool _btree_remove(btree_t *T, node *N, addr_t k, addr_t *rk, addr_t *rv) {
+  if (N->is_leaf) {
+    size_t i = _node_lower(T, N, k);
+    if (i == N->len || T->compare(N->keys[i], k) != 0) {
+      return false;
+    }
+    *rk = N->keys[i];
+    *rv = N->values[i];
+    for (size_t j = i; j + 1 < N->len; j++) {
+      N->keys[j] = N->keys[j + 1];
+      N->values[j] = N->values[j + 1];
+    }
+    N->len--;
+    return true;
+  }
+
+  size_t i = _node_upper(T, N, k);
+  if (!_btree_remove(T, N->children[i], k, rk, rv)) {
+    return false;
+  }
+  if (N->children[i]->len < BTREE_MIN_KEYS) {
+    _btree_fix(N, i);
+  }
+  return true;
+}
+
+/* Separators in internal nodes share their key with the first entry
+ * of a leaf, so once rk is removed from its leaf, any separator still
+ * holding it is replaced by the new first key of the subtree to its
+ * right. Borrows and merges keep such a separator on the search path.
+ */
+void _btree_unlink_key(btree_t *T, addr_t rk) {
+  node *N = T->root;
+  node *C;
+  while (!N->is_leaf) {
+    for (size_t j = 0; j < N->len; j++) {
+      if (N->keys[j] == rk) {
+        C = N->children[j + 1];
+        while (!C->is_leaf) {
+          C = C->children[0];
+        }
+        N->keys[j] = C->keys[0];
+      }
+    }
+    N = N->children[_node_upper(T, N, rk)];
+  }
+}
+
+item_t *btree_del(btree_t *T, addr_t k) {
+  assert(T);
+
+  addr_t rk;
+  addr_t rv;
+  if (!_btree_remove(T, T->root, k, &rk, &rv)) {
+    return NULL;
+  }
+  T->len--;
+
+  // The root may have lost its last separator to a merge.
+  if (!T->root->is_leaf && T->root->len == 0) {
+    node *root = T->root;
+    T->root = root->children[0];
+    memory_free(root);
+  }
+  _btree_unlink_key(T, rk);
+  return item_create(rk, rv);
+}
+
+void _btree_iter_seek(btree_iter_t *It, btree_t *T, node *leaf, size_t index, addr_t hi) {
+  It->T = T;
+  It->leaf = leaf;
+  It->index = index;
+  It->hi = hi;
+  It->key = NULL;
+  It->value = NULL;
+}
+
+void btree_iter_init(btree_iter_t *It, btree_t *T) {
+  assert(It);
+  assert(T);
+
+  node *N = T->root;
+  while (!N->is_leaf) {
+    N = N->children[0];
+  }
+  _btree_iter_seek(It, T, N, 0, NULL);
+}
+
+void btree_range_init(btree_iter_t *It, btree_t *T, addr_t lo, addr_t hi) {
+  assert(It);
+  assert(T);
+
+  if (lo == NULL) {
+    btree_iter_init(It, T);
+  } else {
+    btree_lower_bound(It, T, lo);
+  }
+  It->hi = hi;
+}
+
+void btree_lower_bound(btree_iter_t *It, btree_t *T, addr_t k) {
+  assert(It);
+  assert(T);
+
+  node *L = _btree_leaf(T, k);
+  _btree_iter_seek(It, T, L, _node_lower(T, L, k), NULL);
+}
+
+void btree_upper_bound(btree_iter_t *It, btree_t *T, addr_t k) {
+  assert(It);
+  assert(T);
+
+  node *L = _btree_leaf(T, k);
+  _btree_iter_seek(It, T, L, _node_upper(T, L, k), NULL);
+}
+
+bool btree_iter_next(btree_iter_t *It) {
+  assert(It);
+
+  while (It->leaf != NULL && It->index >= It->leaf->len) {
+    It->leaf = It->leaf->next;
+    It->index = 0;
+  }
+  if (It->leaf == NULL) {
+    return false;
+  }
+
+  addr_t k = It->leaf->keys[It->index];
+  if (It->hi != NULL && It->T->compare(k, It->hi) <= 0) {
+    It->leaf = NULL;
+    return false;
+  }
+  It->key = k;
+  It->value = It->leaf->values[It->index];
+  It->index++;
+  return true;
+}
+
+addr_t btree_iter_key(btree_iter_t *It) {
+  assert(It);
+
+  return It->key;
+}
+
+addr_t btree_iter_value(btree_iter_t *It) {
+  assert(It);
+
+  return It->value;
+}
@@ -0,0 +1,162 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/item.h"
+#include "../include/memory.h"
+#include "../include/btree.h"
+
+void test_basic_btree() {
+  printf("basic btree\n");
+
+  addr_t k;
+  item_t *I;
+
+  btree_t *T = btree_create(int_compare);
+  assert(btree_len(T) == 0);
+
+  k = int_wrap(1);
+  assert(btree_get(T, k) == NULL);
+  assert(btree_del(T, k) == NULL);
+  memory_free(k);
+
+  btree_set(T, int_wrap(2), int_wrap(20));
+  btree_set(T, int_wrap(1), int_wrap(10));
+  assert(btree_len(T) == 2);
+
+  // Setting an existing key replaces its value but keeps its key.
+  k = int_wrap(2);
+  addr_t v = btree_get(T, k);
+  assert(int_unwrap(v) == 20);
+  btree_set(T, k, int_wrap(21));
+  memory_free(k);
+  memory_free(v);
+  assert(btree_len(T) == 2);
+
+  k = int_wrap(2);
+  assert(int_unwrap(btree_get(T, k)) == 21);
+  I = btree_del(T, k);
+  assert(int_unwrap(item_get_key(I)) == 2);
+  assert(int_unwrap(item_get_value(I)) == 21);
+  item_total_destroy(I, memory_free, memory_free);
+  assert(btree_get(T, k) == NULL);
+  memory_free(k);
+  assert(btree_len(T) == 1);
+
+  btree_total_destroy(T, memory_free, memory_free);
+}
+
+void test_btree_order() {
+  printf("btree order\n");
+
+  // Insert and delete in a scrambled order, checking against a
+  // plain array, so that every split, borrow and merge runs.
+  int M = 5000;
+  bool present[5000];
+  for (int i = 0; i < M; i++) {
+    present[i] = false;
+  }
+
+  btree_t *T = btree_create(int_compare);
+  addr_t k;
+  item_t *I;
+  size_t len = 0;
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < M; i++) {
+      int x = (int) (((long) i * 2654435761u + round) % M);
+      k = int_wrap(x);
+      if (round % 2 == 0 && !present[x]) {
+        btree_set(T, k, int_wrap(x));
+        present[x] = true;
+        len++;
+        continue;
+      }
+      if (round % 2 == 1 && present[x] && x % 3 != 0) {
+        I = btree_del(T, k);
+        assert(int_unwrap(item_get_key(I)) == x);
+        item_total_destroy(I, memory_free, memory_free);
+        present[x] = false;
+        len--;
+      }
+      memory_free(k);
+    }
+    assert(btree_len(T) == len);
+
+    btree_iter_t It;
+    btree_iter_init(&It, T);
+    int prev = -1;
+    size_t n = 0;
+    while (btree_iter_next(&It)) {
+      int x = int_unwrap(btree_iter_key(&It));
+      assert(x > prev);
+      assert(present[x]);
+      assert(int_unwrap(btree_iter_value(&It)) == x);
+      prev = x;
+      n++;
+    }
+    assert(n == len);
+  }
+
+  btree_total_destroy(T, memory_free, memory_free);
+}
+
+void test_btree_range() {
+  printf("btree range\n");
+
+  btree_t *T = btree_create(int_compare);
+  for (int i = 0; i < 1000; i += 2) {
+    btree_set(T, int_wrap(i), int_wrap(i));
+  }
+
+  btree_iter_t It;
+  addr_t lo = int_wrap(101);
+  addr_t hi = int_wrap(200);
+
+  btree_range_init(&It, T, lo, hi);
+  int expected = 102;
+  while (btree_iter_next(&It)) {
+    assert(int_unwrap(btree_iter_key(&It)) == expected);
+    expected += 2;
+  }
+  assert(expected == 200);
+
+  btree_range_init(&It, T, NULL, lo);
+  expected = 0;
+  while (btree_iter_next(&It)) {
+    assert(int_unwrap(btree_iter_key(&It)) == expected);
+    expected += 2;
+  }
+  assert(expected == 102);
+
+  btree_lower_bound(&It, T, hi);
+  assert(btree_iter_next(&It));
+  assert(int_unwrap(btree_iter_key(&It)) == 200);
+
+  btree_upper_bound(&It, T, hi);
+  assert(btree_iter_next(&It));
+  assert(int_unwrap(btree_iter_key(&It)) == 202);
+
+  memory_free(lo);
+  lo = int_wrap(998);
+  btree_upper_bound(&It, T, lo);
+  assert(!btree_iter_next(&It));
+
+  memory_free(lo);
+  memory_free(hi);
+  btree_total_destroy(T, memory_free, memory_free);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_basic_btree();
+  test_btree_order();
+  test_btree_range();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
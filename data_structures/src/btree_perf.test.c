@@ -0,0 +1,88 @@
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/test_utils.h"
+#include "../include/hash.h"
+#include "../include/memory.h"
+#include "../include/list_extended.h"
+#include "../include/dict_extended.h"
+#include "../include/btree.h"
+
+int _item_compare(addr_t I1, addr_t I2) {
+  return int_compare(item_get_key((item_t *) I1), item_get_key((item_t *) I2));
+}
+
+// Sum the values of Q ranges of W keys each, out of N keys,
+// by sorting the items of a dict_t and by scanning a btree_t.
+void test_btree_range_performance() {
+  int MAG = 3;
+  dict_t *D;
+  btree_t *T;
+  list_t *S;
+  list_t *L;
+  btree_iter_t It;
+  addr_t lo;
+  addr_t hi;
+  long total;
+  clock_t start;
+  clock_t end;
+
+  size_t N = 100000;
+  size_t Q = 8;
+  size_t W = 1000;
+
+  for (int i = 0; i < MAG; i++) {
+    D = dict_create(int_eq, hash_int);
+    T = btree_create(int_compare);
+    for (int j = 0; j < N; j++) {
+      int x = (int) (((long) j * 2654435761u) % N);
+      dict_set(D, int_wrap(x), int_wrap(x));
+      btree_set(T, int_wrap(x), int_wrap(x));
+    }
+
+    printf("# ITEMS: %lu\n", N);
+
+    total = 0;
+    start = clock();
+    for (int q = 0; q < Q; q++) {
+      int first = (int) ((N - W) * q / Q);
+      L = dict_items(D);
+      S = list_sort(L, _item_compare);
+      for (int j = first; j < first + W; j++) {
+        total += int_unwrap(item_get_value((item_t *) list_get(S, j)));
+      }
+      list_destroy(S);
+      list_destroy(L);
+    }
+    end = clock();
+    printf("SECS (DICT SORT): %lf\n", ((double) (end - start)) / CLOCKS_PER_SEC);
+
+    start = clock();
+    for (int q = 0; q < Q; q++) {
+      int first = (int) ((N - W) * q / Q);
+      lo = int_wrap(first);
+      hi = int_wrap(first + W);
+      btree_range_init(&It, T, lo, hi);
+      while (btree_iter_next(&It)) {
+        total -= int_unwrap(btree_iter_value(&It));
+      }
+      memory_free(lo);
+      memory_free(hi);
+    }
+    end = clock();
+    printf("SECS (BTREE RANGE): %lf\n", ((double) (end - start)) / CLOCKS_PER_SEC);
+    assert(total == 0);
+
+    dict_total_destroy(D, memory_free, memory_free);
+    btree_total_destroy(T, memory_free, memory_free);
+
+    N *= 4;
+  }
+}
+
+int main() {
+  test_btree_range_performance();
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 
 #include "../include/test_utils.h"
@@ -11,6 +12,8 @@
 #include "../include/dict_conn.h"
 #include "../include/set_conn.h"
 #include "../include/heap_conn.h"
+#include "../include/skiplist_conn.h"
+#include "../include/intern_conn.h"
 
 void test_list_conn() {
   printf("list conn\n");
@@ -44,6 +47,252 @@ void test_heap_conn() {
   heap_conn_destroy(HC);
 }
 
+size_t num_reclaimed = 0;
+
+void _count_reclaimed(addr_t k) {
+  num_reclaimed++;
+  memory_free(k);
+}
+
+void test_skiplist_conn() {
+  printf("skiplist conn\n");
+
+  skiplist_conn_t *SC = skiplist_conn_create(int_compare);
+  assert(skiplist_conn_len(SC) == 0);
+
+  addr_t k;
+  addr_t v;
+  for (int i = 0; i < 100; i++) {
+    skiplist_conn_set(SC, int_wrap((i * 37) % 100), int_wrap(i));
+  }
+  assert(skiplist_conn_len(SC) == 100);
+
+  k = int_wrap(74);
+  v = skiplist_conn_get(SC, k);
+  assert(int_unwrap(v) == 2);
+  memory_free(v);
+  skiplist_conn_set(SC, k, int_wrap(-1));
+  assert(int_unwrap(skiplist_conn_get(SC, k)) == -1);
+  assert(skiplist_conn_len(SC) == 100);
+  v = skiplist_conn_del(SC, k);
+  assert(int_unwrap(v) == -1);
+  memory_free(v);
+  assert(skiplist_conn_get(SC, k) == NULL);
+  assert(skiplist_conn_del(SC, k) == NULL);
+  assert(skiplist_conn_len(SC) == 99);
+  memory_free(k);
+
+  skiplist_conn_iter_t It;
+  skiplist_conn_iter_init(&It, SC);
+  int expected = 0;
+  while (skiplist_conn_iter_next(&It)) {
+    if (expected == 74) {
+      expected++;
+    }
+    assert(int_unwrap(skiplist_conn_iter_key(&It)) == expected);
+    expected++;
+  }
+  assert(expected == 100);
+
+  addr_t lo = int_wrap(70);
+  addr_t hi = int_wrap(80);
+  skiplist_conn_range_init(&It, SC, lo, hi);
+  expected = 70;
+  while (skiplist_conn_iter_next(&It)) {
+    if (expected == 74) {
+      expected++;
+    }
+    assert(int_unwrap(skiplist_conn_iter_key(&It)) == expected);
+    expected++;
+  }
+  assert(expected == 80);
+  memory_free(lo);
+  memory_free(hi);
+
+  skiplist_conn_reclaim(SC, _count_reclaimed);
+  assert(num_reclaimed == 1);
+
+  // A scan that is still going keeps nodes removed during it,
+  // until it is finished.
+  skiplist_conn_iter_init(&It, SC);
+  assert(skiplist_conn_iter_next(&It));
+  k = int_wrap(75);
+  memory_free(skiplist_conn_del(SC, k));
+  memory_free(k);
+  skiplist_conn_reclaim(SC, _count_reclaimed);
+  assert(num_reclaimed == 1);
+  skiplist_conn_iter_finish(&It);
+  skiplist_conn_iter_finish(&It);
+  skiplist_conn_reclaim(SC, _count_reclaimed);
+  assert(num_reclaimed == 2);
+
+  skiplist_conn_total_destroy(SC, memory_free, memory_free);
+}
+
+#define SKIPLIST_THREADS 4
+#define SKIPLIST_KEYS_PER_THREAD 2000
+
+struct _skiplist_task {
+  skiplist_conn_t *SC;
+  int t;
+  bool *done;
+};
+
+void *_skiplist_insert(void *arg) {
+  struct _skiplist_task *task = (struct _skiplist_task *) arg;
+  for (int i = 0; i < SKIPLIST_KEYS_PER_THREAD; i++) {
+    int x = i * SKIPLIST_THREADS + task->t;
+    skiplist_conn_set(task->SC, int_wrap(x), int_wrap(x));
+  }
+  return NULL;
+}
+
+void *_skiplist_delete_odd(void *arg) {
+  struct _skiplist_task *task = (struct _skiplist_task *) arg;
+  addr_t k;
+  for (int i = 0; i < SKIPLIST_KEYS_PER_THREAD; i++) {
+    int x = i * SKIPLIST_THREADS + task->t;
+    if (x % 2 == 1) {
+      k = int_wrap(x);
+      memory_free(skiplist_conn_del(task->SC, k));
+      memory_free(k);
+    }
+    // Reclaim while the scan and the other writers run.
+    if (i % 64 == 0) {
+      skiplist_conn_reclaim(task->SC, memory_free);
+    }
+  }
+  return NULL;
+}
+
+// Scan while the writers run: keys must always come out in order.
+void *_skiplist_scan(void *arg) {
+  struct _skiplist_task *task = (struct _skiplist_task *) arg;
+  skiplist_conn_iter_t It;
+  int prev;
+  int x;
+  while (!__atomic_load_n(task->done, __ATOMIC_ACQUIRE)) {
+    prev = -1;
+    skiplist_conn_iter_init(&It, task->SC);
+    while (skiplist_conn_iter_next(&It)) {
+      x = int_unwrap(skiplist_conn_iter_key(&It));
+      assert(x > prev);
+      prev = x;
+    }
+  }
+  return NULL;
+}
+
+void _skiplist_run(skiplist_conn_t *SC, void *(*writer)(void *arg)) {
+  pthread_t writers[SKIPLIST_THREADS];
+  pthread_t reader;
+  struct _skiplist_task tasks[SKIPLIST_THREADS];
+  bool done = false;
+  struct _skiplist_task scan = {SC, -1, &done};
+
+  pthread_create(&reader, NULL, _skiplist_scan, &scan);
+  for (int t = 0; t < SKIPLIST_THREADS; t++) {
+    tasks[t].SC = SC;
+    tasks[t].t = t;
+    tasks[t].done = &done;
+    pthread_create(&writers[t], NULL, writer, &tasks[t]);
+  }
+  for (int t = 0; t < SKIPLIST_THREADS; t++) {
+    pthread_join(writers[t], NULL);
+  }
+  __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+  pthread_join(reader, NULL);
+}
+
+void test_skiplist_conn_threads() {
+  printf("skiplist conn threads\n");
+
+  size_t n = SKIPLIST_THREADS * SKIPLIST_KEYS_PER_THREAD;
+  skiplist_conn_t *SC = skiplist_conn_create(int_compare);
+
+  _skiplist_run(SC, _skiplist_insert);
+  assert(skiplist_conn_len(SC) == n);
+
+  _skiplist_run(SC, _skiplist_delete_odd);
+  assert(skiplist_conn_len(SC) == n / 2);
+
+  skiplist_conn_iter_t It;
+  skiplist_conn_iter_init(&It, SC);
+  int expected = 0;
+  while (skiplist_conn_iter_next(&It)) {
+    assert(int_unwrap(skiplist_conn_iter_key(&It)) == expected);
+    expected += 2;
+  }
+  assert(expected == n);
+
+  skiplist_conn_total_destroy(SC, memory_free, memory_free);
+}
+
+#define INTERN_THREADS 4
+#define INTERN_WORDS 200
+
+struct _intern_task {
+  intern_conn_t *TC;
+  str_t *canonical;
+};
+
+// Intern the same words from every thread, in a different order each.
+void *_intern_words(void *arg) {
+  struct _intern_task *task = (struct _intern_task *) arg;
+  char buf[32];
+  str_t s;
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < INTERN_WORDS; i++) {
+      int w = (i * 7 + round) % INTERN_WORDS;
+      snprintf(buf, sizeof(buf), "metric.%d", w);
+      s = intern_conn_str(task->TC, buf);
+      assert(strcmp(s, buf) == 0);
+      if (task->canonical != NULL) {
+        assert(s == task->canonical[w]);
+      }
+    }
+  }
+  return NULL;
+}
+
+void test_intern_conn() {
+  printf("intern conn\n");
+
+  intern_conn_t *TC = intern_conn_create(intern_create());
+  pthread_t threads[INTERN_THREADS];
+  struct _intern_task task = {TC, NULL};
+  for (int t = 0; t < INTERN_THREADS; t++) {
+    pthread_create(&threads[t], NULL, _intern_words, &task);
+  }
+  for (int t = 0; t < INTERN_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  assert(intern_conn_len(TC) == INTERN_WORDS);
+
+  // Every thread got the same pointers.
+  str_t canonical[INTERN_WORDS];
+  char buf[32];
+  for (int w = 0; w < INTERN_WORDS; w++) {
+    snprintf(buf, sizeof(buf), "metric.%d", w);
+    canonical[w] = intern_conn_get(TC, str_view(buf));
+    assert(canonical[w] != NULL);
+  }
+  task.canonical = canonical;
+  for (int t = 0; t < INTERN_THREADS; t++) {
+    pthread_create(&threads[t], NULL, _intern_words, &task);
+  }
+  for (int t = 0; t < INTERN_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  intern_stats_t stats;
+  intern_conn_stats(TC, &stats);
+  assert(stats.len == INTERN_WORDS);
+  assert(stats.num_hits == 2 * INTERN_THREADS * 10 * INTERN_WORDS - INTERN_WORDS);
+
+  intern_conn_destroy(TC);
+}
+
 int main() {
   memory_pointers_init();
 
@@ -51,6 +300,9 @@ int main() {
   test_dict_conn();
   test_set_conn();
   test_heap_conn();
+  test_skiplist_conn();
+  test_skiplist_conn_threads();
+  test_intern_conn();
 
   str_t usage = memory_pointers_report();
   str_t expected = "->";
@@ -1,107 +1,128 @@
 #include <assert.h>
+#include <stdint.h>
 
+#include "../include/hash.h"
 #include "../include/item.h"
 #include "../include/list.h"
 #include "../include/memory.h"
 #include "../include/dict.h"
 
-/* List implementation of the bucket.
+/* Array implementation of the bucket.
  * If the size of each bucket is small,
- * then a list_t is simpler to use
- * and practically more efficient,
+ * then a flat array is simpler to use
+ * and practically more efficient than
  * a heap, despite the latter being
  * theoretically more efficient.
+ *
+ * The full hash of each key is kept next to its item,
+ * so that key_eq is only called when the hashes match
+ * and resizing never has to call key_hash again.
  */
+#define BUCKET_INITIAL_CAPACITY 2
+
+struct _bucket_entry {
+  item_t *I;
+  size_t hash;
+};
+typedef struct _bucket_entry entry;
+
 struct _bucket {
-  list_t *L;
+  size_t len;
+  size_t capacity;
+  entry *entries;
   bool (*key_eq) (addr_t k1, addr_t k2);
 };
 typedef struct _bucket bucket;
 
 bucket *bucket_create(bool (*key_eq) (addr_t k1, addr_t k2)) {
-  list_t *L = list_create(0);
   bucket *B = (bucket *) memory_malloc(sizeof(bucket));
-  B->L = L;
+  B->len = 0;
+  B->capacity = BUCKET_INITIAL_CAPACITY;
+  B->entries = (entry *) memory_malloc(B->capacity * sizeof(entry));
   B->key_eq = key_eq;
   return B;
 }
 
-void bucket_destroy(bucket *B) {
-  assert(B);
-
-  size_t n = list_len(B->L);
-
-  addr_t I;
-  for (int i = 0; i < n; i++) {
-    I = list_get(B->L, i); 
-    item_destroy(I);
-  }
-
-  list_destroy(B->L);
+// Free B, but not its items.
+void _bucket_free(bucket *B) {
+  memory_free(B->entries);
   memory_free(B);
 }
 
-item_t *_bucket_item(bucket *B, addr_t k) {
+void bucket_destroy(bucket *B) {
   assert(B);
 
-  size_t n = list_len(B->L);
+  for (size_t i = 0; i < B->len; i++) {
+    item_destroy(B->entries[i].I);
+  }
+  _bucket_free(B);
+}
 
-  item_t *I;
-  for (int i = 0; i < n; i++) {
-    I = (item_t *) list_get(B->L, i);
-    if (B->key_eq(item_get_key(I), k)) {
-      return I;
+// If k is in B, set *i to its position and return true.
+bool _bucket_find(bucket *B, addr_t k, size_t hash, size_t *i) {
+  for (size_t j = 0; j < B->len; j++) {
+    if (B->entries[j].hash != hash) {
+      continue;
+    }
+    if (B->key_eq(item_get_key(B->entries[j].I), k)) {
+      *i = j;
+      return true;
     }
   }
-  return NULL;
+  return false;
 }
 
-addr_t bucket_get(bucket *B, addr_t k) {
+item_t *_bucket_item(bucket *B, addr_t k, size_t hash) {
   assert(B);
 
-  item_t *I = _bucket_item(B, k);
-  if (I == NULL) {
+  size_t i;
+  if (!_bucket_find(B, k, hash, &i)) {
     return NULL;
-  } else {
-    return item_get_value(I);
   }
+  return B->entries[i].I;
 }
 
-void bucket_set(bucket *B, addr_t k, addr_t v) {
+addr_t bucket_get(bucket *B, addr_t k, size_t hash) {
   assert(B);
 
-  item_t *I = _bucket_item(B, k);
+  item_t *I = _bucket_item(B, k, hash);
   if (I == NULL) {
-    I = item_create(k, v);
-    list_push(B->L, I);
+    return NULL;
   } else {
-    item_set_value(I, v);
+    return item_get_value(I);
   }
 }
 
-item_t *bucket_del(bucket *B, addr_t k) {
+void bucket_push(bucket *B, item_t *I, size_t hash) {
   assert(B);
 
-  size_t n = list_len(B->L);
-
-  addr_t I;
-  for (int i = 0; i < n; i++) {
-    I = list_get(B->L, i);
-    if (B->key_eq(item_get_key(I), k)) {
-      list_remove(B->L, i);
-      return I;
-    }
+  if (B->len == B->capacity) {
+    entry *entries = (entry *) memory_malloc(2 * B->capacity * sizeof(entry));
+    memcpy(entries, B->entries, B->len * sizeof(entry));
+    memory_free(B->entries);
+    B->entries = entries;
+    B->capacity *= 2;
   }
-
-  return NULL;
+  B->entries[B->len].I = I;
+  B->entries[B->len].hash = hash;
+  B->len++;
 }
 
-list_t *bucket_items(bucket *B) {
+item_t *bucket_del(bucket *B, addr_t k, size_t hash) {
   assert(B);
 
-  return B->L;
+  size_t i;
+  if (!_bucket_find(B, k, hash, &i)) {
+    return NULL;
+  }
+  item_t *I = B->entries[i].I;
+  memmove(B->entries + i, B->entries + i + 1, (B->len - i - 1) * sizeof(entry));
+  B->len--;
+  return I;
 }
 
+#define DICT_SMALL_CAPACITY 8
+
 struct _impl_dict_t {
   /* Allow amortized O(1) get/set of a value at a key.
    *
@@ -113,102 +134,186 @@ struct _impl_dict_t {
    * then in expectation, there are <=C keys at each index.
    * Then can do O(n) resize operation whenver the following is not true:
    * m / 2 < n <= m.
+   *
+   * Most dicts only ever hold a handful of keys, so up to
+   * DICT_SMALL_CAPACITY items are kept in a flat array inside the
+   * dict_t instead, and scanned linearly. A dict that never grew keeps
+   * them in insertion order, but one that shrank back keeps the order
+   * they had in the table, so callers are not promised any order.
+   * While small, buckets is NULL. The table is built once n goes past
+   * DICT_SMALL_CAPACITY, and dropped again once n falls to half of it.
    */
   size_t len;
   list_t *buckets;
+  item_t *small[DICT_SMALL_CAPACITY];
+  size_t small_hashes[DICT_SMALL_CAPACITY];
   size_t (*key_hash) (addr_t k);
   bool (*key_eq) (addr_t k1, addr_t k2);
 };
 
-size_t _buckets_index(list_t *buckets, addr_t k, size_t (*key_hash)(addr_t k)) {
-  size_t num_buckets = list_len(buckets);
+/* The number of buckets is always a power of two,
+ * so the index is taken by hash_slot rather than by division.
+ */
+size_t _buckets_hash_index(size_t num_buckets, size_t hash) {
   assert(num_buckets > 0);
+  assert((num_buckets & (num_buckets - 1)) == 0);
 
-  size_t index;
-  if (num_buckets == 1) {
-    index = 0;
-  } else {
-    size_t hash = key_hash(k);
-    index = hash % num_buckets;
-  }
-  return index;
+  return hash_slot(hash, num_buckets);
 }
 
-bucket *_get_bucket(list_t *buckets, addr_t k, size_t (*key_hash)(addr_t k)) {
+/* Buckets are only created once a key lands in them,
+ * so a table can have NULL in place of empty buckets.
+ */
+bucket *_get_bucket(list_t *buckets, size_t hash) {
   size_t num_buckets = list_len(buckets);
   if (num_buckets == 0) {
     return NULL;
   }
-  size_t index = _buckets_index(buckets, k, key_hash);
+  size_t index = _buckets_hash_index(num_buckets, hash);
   assert(index < num_buckets);
   bucket *B = (bucket *) list_get(buckets, index);
   return B;
 } 
 
-void _dict_resize(dict_t *D, size_t new_len) {
-  size_t curr_capacity = list_len(D->buckets);
-  if (curr_capacity / 2 < new_len && new_len <= curr_capacity) {
-    D->len = new_len;
-    return;
+bucket *_get_or_create_bucket(list_t *buckets, size_t hash, bool (*key_eq) (addr_t k1, addr_t k2)) {
+  size_t num_buckets = list_len(buckets);
+  assert(num_buckets > 0);
+
+  size_t index = _buckets_hash_index(num_buckets, hash);
+  bucket *B = (bucket *) list_get(buckets, index);
+  if (B == NULL) {
+    B = bucket_create(key_eq);
+    list_set(buckets, index, B);
   }
+  return B;
+}
 
-  size_t new_capacity = 0;
-  if (new_len > 0) {
-    if (curr_capacity == 0) {
-      new_capacity = 1;
-    } else {
-      new_capacity = curr_capacity;
+bool _dict_is_small(dict_t *D) {
+  return D->buckets == NULL;
+}
+
+// Move item I with the given hash into the new representation.
+void _dict_place(dict_t *D, list_t *buckets, size_t *n, item_t *I, size_t hash) {
+  if (buckets == NULL) {
+    assert(*n < DICT_SMALL_CAPACITY);
+    D->small[*n] = I;
+    D->small_hashes[*n] = hash;
+  } else {
+    bucket *B = _get_or_create_bucket(buckets, hash, D->key_eq);
+    bucket_push(B, I, hash);
+  }
+  (*n)++;
+}
+
+// Rebuild D with new_capacity buckets,
+// or as a small dict if new_capacity is 0.
+void _dict_rebuild(dict_t *D, size_t new_capacity) {
+  bucket *O;
+  size_t n = 0;
+
+  list_t *buckets = NULL;
+  if (new_capacity > 0) {
+    buckets = list_create(new_capacity);
+  }
+
+  // Move the existing items over in place rather than recreating them,
+  // placing them by their cached hashes.
+  list_t *old_buckets = D->buckets;
+  if (old_buckets == NULL) {
+    // Going from small to small leaves nothing to move.
+    if (buckets == NULL) {
+      return;
+    }
+    for (int i = 0; i < D->len; i++) {
+      _dict_place(D, buckets, &n, D->small[i], D->small_hashes[i]);
     }
-    while (new_capacity < new_len) {
-      new_capacity *= 2;
-    } 
-    while (new_capacity >= 2 * new_len) {
-      new_capacity /= 2;
+  } else {
+    for (int i = 0; i < list_len(old_buckets); i++) {
+      O = list_get(old_buckets, i);
+      if (O == NULL) {
+        continue;
+      }
+      for (size_t j = 0; j < O->len; j++) {
+        _dict_place(D, buckets, &n, O->entries[j].I, O->entries[j].hash);
+      }
+      _bucket_free(O);
     }
+    list_destroy(old_buckets);
   }
 
-  bucket *B;
-  addr_t I;
-  addr_t k;
-  addr_t v;
+  D->buckets = buckets;
+}
 
-  list_t *buckets = list_create(new_capacity);
-  for (int i = 0; i < new_capacity; i++) {
-    B = bucket_create(D->key_eq);
-    list_set(buckets, i, B);
+void _dict_resize(dict_t *D, size_t new_len) {
+  size_t curr_capacity = 0;
+  if (_dict_is_small(D)) {
+    if (new_len <= DICT_SMALL_CAPACITY) {
+      D->len = new_len;
+      return;
+    }
+  } else {
+    if (new_len <= DICT_SMALL_CAPACITY / 2) {
+      _dict_rebuild(D, 0);
+      D->len = new_len;
+      return;
+    }
+    curr_capacity = list_len(D->buckets);
+    if (curr_capacity / 2 < new_len && new_len <= curr_capacity) {
+      D->len = new_len;
+      return;
+    }
+    if (new_len > D->len && new_len <= curr_capacity) {
+      // Never shrink while growing, which would undo dict_reserve.
+      D->len = new_len;
+      return;
+    }
   }
 
-  list_t *items = dict_items(D);
-  size_t copy_len = list_len(items);
-  if (new_capacity < copy_len) {
-    copy_len = new_capacity;
+  size_t new_capacity = 1;
+  if (curr_capacity > 0) {
+    new_capacity = curr_capacity;
   }
-  for (int i = 0; i < copy_len; i++) {
-    I = list_get(items, i); 
-    k = item_get_key(I);
-    v = item_get_value(I);
-    B = _get_bucket(buckets, k, D->key_hash);
-    assert(B);
-    bucket_set(B, k, v);
+  while (new_capacity < new_len) {
+    new_capacity *= 2;
+  } 
+  while (new_capacity >= 2 * new_len) {
+    new_capacity /= 2;
   }
-  list_destroy(items);
 
-  list_t *old_buckets = D->buckets;
-  for (int i = 0; i < list_len(old_buckets); i++) {
-    B = list_get(old_buckets, i);
-    bucket_destroy(B);
+  _dict_rebuild(D, new_capacity);
+  D->len = new_len;
+}
+
+// Grow the table once so that it can hold n keys without resizing.
+// This may break m / 2 < n until keys are deleted again.
+// A small dict that can already hold n keys is left as it is.
+void _dict_reserve(dict_t *D, size_t n) {
+  size_t curr_capacity = DICT_SMALL_CAPACITY;
+  if (!_dict_is_small(D)) {
+    curr_capacity = list_len(D->buckets);
+  }
+  if (n <= curr_capacity) {
+    return;
   }
-  list_destroy(old_buckets);
 
-  D->len = new_len;
-  D->buckets = buckets;
+  size_t new_capacity = 1;
+  while (new_capacity < n) {
+    new_capacity *= 2;
+  }
+  _dict_rebuild(D, new_capacity);
+}
+
+void dict_reserve(dict_t *D, size_t n) {
+  assert(D);
+
+  _dict_reserve(D, n);
 }
 
 dict_t *dict_create(bool (*key_eq) (addr_t k1, addr_t k2), size_t (*key_hash) (addr_t k)) {
   dict_t *D = (dict_t *) memory_malloc(sizeof(dict_t));
 
   D->len = 0;
-  D->buckets = list_create(0);
+  D->buckets = NULL;
   D->key_hash = key_hash;
   D->key_eq = key_eq;
 
@@ -218,12 +323,20 @@ dict_t *dict_create(bool (*key_eq) (addr_t k1, addr_t k2), size_t (*key_hash) (a
 void dict_destroy(dict_t *D) {
   assert(D);
 
-  bucket *B;
-  for (int i = 0; i < list_len(D->buckets); i++) {
-    B = list_get(D->buckets, i);
-    bucket_destroy(B);
+  if (_dict_is_small(D)) {
+    for (int i = 0; i < D->len; i++) {
+      item_destroy(D->small[i]);
+    }
+  } else {
+    bucket *B;
+    for (int i = 0; i < list_len(D->buckets); i++) {
+      B = list_get(D->buckets, i);
+      if (B != NULL) {
+        bucket_destroy(B);
+      }
+    }
+    list_destroy(D->buckets);
   }
-  list_destroy(D->buckets);
 
   memory_free(D);
 }
@@ -247,59 +360,389 @@ size_t dict_len(dict_t *D) {
   return len;
 }
 
+// If k is in the small array of D, set *i to its position and return true.
+bool _dict_small_find(dict_t *D, addr_t k, size_t hash, size_t *i) {
+  for (size_t j = 0; j < D->len; j++) {
+    if (D->small_hashes[j] != hash) {
+      continue;
+    }
+    if (D->key_eq(item_get_key(D->small[j]), k)) {
+      *i = j;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Return the item at k, or NULL if k does not exist in D.
+item_t *_dict_item(dict_t *D, addr_t k, size_t hash) {
+  if (_dict_is_small(D)) {
+    size_t i;
+    if (!_dict_small_find(D, k, hash, &i)) {
+      return NULL;
+    }
+    return D->small[i];
+  }
+
+  bucket *B = _get_bucket(D->buckets, hash);
+  if (B == NULL) {
+    return NULL;
+  }
+  return _bucket_item(B, k, hash);
+}
+
+// Remove and return the item at k, or NULL if k does not exist in D.
+// Does not update D->len.
+item_t *_dict_remove(dict_t *D, addr_t k, size_t hash) {
+  if (_dict_is_small(D)) {
+    size_t i;
+    if (!_dict_small_find(D, k, hash, &i)) {
+      return NULL;
+    }
+    // Shift the rest down to keep their order.
+    item_t *I = D->small[i];
+    for (size_t j = i + 1; j < D->len; j++) {
+      D->small[j - 1] = D->small[j];
+      D->small_hashes[j - 1] = D->small_hashes[j];
+    }
+    return I;
+  }
+
+  bucket *B = _get_bucket(D->buckets, hash);
+  if (B == NULL) {
+    return NULL;
+  }
+  return bucket_del(B, k, hash);
+}
+
 addr_t dict_get(dict_t *D, addr_t k) {
   assert(D);
 
-  bucket *B = _get_bucket(D->buckets, k, D->key_hash);
-  if (B == NULL) {
+  if (D->len == 0) {
+    return NULL;
+  }
+  return dict_get_hashed(D, k, D->key_hash(k));
+}
+
+addr_t dict_get_hashed(dict_t *D, addr_t k, size_t hash) {
+  assert(D);
+
+  if (D->len == 0) {
+    return NULL;
+  }
+
+  item_t *I = _dict_item(D, k, hash);
+  if (I == NULL) {
     return NULL;
   }
-  addr_t v = bucket_get(B, k);
-  return v;
+  return item_get_value(I);
 }
 
 list_t *dict_items(dict_t *D) {
   assert(D);
 
-  list_t *all_items = list_create(0);
-  size_t num_buckets = list_len(D->buckets);
+  list_t *all_items = list_create(D->len);
 
-  list_t *items;
-  bucket *B;
-  item_t *I;
-  for (int i = 0; i < num_buckets; i++) {
-    B = (bucket *) list_get(D->buckets, i);
-    items = bucket_items(B);
-    for (int j = 0; j < list_len(items); j++) {
-      I = list_get(items, j);
-      list_push(all_items, I);
-    };
+  size_t i = 0;
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    list_set(all_items, i, dict_iter_item(&It));
+    i++;
   }
   return all_items;
 }
 
+void dict_iter_init(dict_iter_t *It, dict_t *D) {
+  assert(It);
+  assert(D);
+
+  It->D = D;
+  It->bucket = 0;
+  It->index = 0;
+  It->I = NULL;
+}
+
+bool dict_iter_next(dict_iter_t *It) {
+  assert(It);
+
+  dict_t *D = It->D;
+  if (_dict_is_small(D)) {
+    if (It->index < D->len) {
+      It->I = D->small[It->index];
+      It->index++;
+      return true;
+    }
+    It->I = NULL;
+    return false;
+  }
+
+  list_t *buckets = D->buckets;
+  size_t num_buckets = list_len(buckets);
+
+  bucket *B;
+  while (It->bucket < num_buckets) {
+    B = (bucket *) list_get(buckets, It->bucket);
+    if (B != NULL && It->index < B->len) {
+      It->I = B->entries[It->index].I;
+      It->index++;
+      return true;
+    }
+    It->bucket++;
+    It->index = 0;
+  }
+  It->I = NULL;
+  return false;
+}
+
+item_t *dict_iter_item(dict_iter_t *It) {
+  assert(It);
+  assert(It->I);
+
+  return It->I;
+}
+
+addr_t dict_iter_key(dict_iter_t *It) {
+  return item_get_key(dict_iter_item(It));
+}
+
+addr_t dict_iter_value(dict_iter_t *It) {
+  return item_get_value(dict_iter_item(It));
+}
+
+// Find the item at k, inserting (k, v) if there is none,
+// with a single hash of k and a single scan of its bucket.
+item_t *_dict_find_or_insert(dict_t *D, addr_t k, addr_t v, bool *inserted) {
+  size_t hash = D->key_hash(k);
+
+  item_t *I = _dict_item(D, k, hash);
+  if (I != NULL) {
+    *inserted = false;
+    return I;
+  }
+
+  _dict_resize(D, D->len + 1);
+
+  I = item_create(k, v);
+  if (_dict_is_small(D)) {
+    D->small[D->len - 1] = I;
+    D->small_hashes[D->len - 1] = hash;
+  } else {
+    bucket_push(_get_or_create_bucket(D->buckets, hash, D->key_eq), I, hash);
+  }
+  *inserted = true;
+  return I;
+}
+
 void dict_set(dict_t *D, addr_t k, addr_t v) {
   assert(D);
 
-  if (dict_get(D, k) == NULL) {
-    _dict_resize(D, D->len + 1);
+  bool inserted;
+  item_t *I = _dict_find_or_insert(D, k, v, &inserted);
+  if (!inserted) {
+    item_set_value(I, v);
   }
-  bucket *B = _get_bucket(D->buckets, k, D->key_hash);
-  assert(B);
-  bucket_set(B, k, v);
+}
+
+addr_t *dict_upsert(dict_t *D, addr_t k, addr_t (*update)(addr_t v)) {
+  assert(D);
+
+  bool inserted;
+  item_t *I = _dict_find_or_insert(D, k, NULL, &inserted);
+  addr_t *slot = item_value_slot(I);
+  *slot = update(*slot);
+  return slot;
+}
+
+addr_t *dict_get_or_insert(dict_t *D, addr_t k, addr_t v) {
+  assert(D);
+
+  bool inserted;
+  item_t *I = _dict_find_or_insert(D, k, v, &inserted);
+  return item_value_slot(I);
 }
 
 item_t *dict_del(dict_t *D, addr_t k) {
   assert(D);
 
-  if (dict_get(D, k) == NULL) {
+  if (D->len == 0) {
     return NULL;
   }
 
-  bucket *B = _get_bucket(D->buckets, k, D->key_hash);
-  assert(B);
-
-  item_t *I = bucket_del(B, k);
-  _dict_resize(D, D->len - 1);
+  item_t *I = _dict_remove(D, k, D->key_hash(k));
+  if (I != NULL) {
+    _dict_resize(D, D->len - 1);
+  }
   return I;
 }
+
+/* Batch operations.
+ *
+ * Keys are hashed DICT_PREFETCH_DISTANCE positions ahead of the one
+ * being probed, so each key is hashed exactly once and its bucket has
+ * been requested from memory by the time the probe reaches it.
+ * The table must not be resized while a batch is in flight.
+ * Small dicts have no buckets to fetch, so they skip the batching.
+ */
+#define DICT_PREFETCH_DISTANCE 8
+
+#if defined(__GNUC__)
+#define _dict_prefetch(p) __builtin_prefetch(p)
+#else
+#define _dict_prefetch(p)
+#endif
+
+struct _batch {
+  list_t *keys;
+  list_t *buckets;
+  size_t (*key_hash) (addr_t k);
+  size_t hashes[DICT_PREFETCH_DISTANCE];
+};
+typedef struct _batch batch;
+
+void _batch_load(batch *W, size_t i) {
+  if (i >= list_len(W->keys)) {
+    return;
+  }
+  size_t hash = W->key_hash(list_get(W->keys, i));
+  W->hashes[i % DICT_PREFETCH_DISTANCE] = hash;
+
+  size_t index = _buckets_hash_index(list_len(W->buckets), hash);
+  _dict_prefetch(list_get(W->buckets, index));
+}
+
+void _batch_init(batch *W, dict_t *D, list_t *keys) {
+  W->keys = keys;
+  W->buckets = D->buckets;
+  W->key_hash = D->key_hash;
+  for (int i = 0; i < DICT_PREFETCH_DISTANCE; i++) {
+    _batch_load(W, i);
+  }
+}
+
+// Return the bucket of the key at i and set *hash to the key's hash.
+bucket *_batch_bucket(batch *W, size_t i, size_t *hash) {
+  *hash = W->hashes[i % DICT_PREFETCH_DISTANCE];
+  _batch_load(W, i + DICT_PREFETCH_DISTANCE);
+
+  return _get_bucket(W->buckets, *hash);
+}
+
+void dict_set_many(dict_t *D, list_t *keys, list_t *values) {
+  assert(D);
+  assert(keys);
+  assert(values);
+
+  size_t n = list_len(keys);
+  assert(list_len(values) == n);
+  if (n == 0) {
+    return;
+  }
+
+  _dict_reserve(D, D->len + n);
+  if (_dict_is_small(D)) {
+    for (int i = 0; i < n; i++) {
+      dict_set(D, list_get(keys, i), list_get(values, i));
+    }
+    return;
+  }
+
+  batch W;
+  _batch_init(&W, D, keys);
+
+  bucket *B;
+  item_t *I;
+  addr_t k;
+  addr_t v;
+  size_t hash;
+  for (int i = 0; i < n; i++) {
+    B = _batch_bucket(&W, i, &hash);
+    k = list_get(keys, i);
+    v = list_get(values, i);
+    I = NULL;
+    if (B != NULL) {
+      I = _bucket_item(B, k, hash);
+    } else {
+      B = _get_or_create_bucket(W.buckets, hash, D->key_eq);
+    }
+    if (I == NULL) {
+      bucket_push(B, item_create(k, v), hash);
+      D->len++;
+    } else {
+      item_set_value(I, v);
+    }
+  }
+
+  // Shrink back if the batch held many repeated keys.
+  _dict_resize(D, D->len);
+}
+
+list_t *dict_get_many(dict_t *D, list_t *keys) {
+  assert(D);
+  assert(keys);
+
+  size_t n = list_len(keys);
+  list_t *values = list_create(n);
+  if (n == 0) {
+    return values;
+  }
+  if (_dict_is_small(D)) {
+    for (int i = 0; i < n; i++) {
+      list_set(values, i, dict_get(D, list_get(keys, i)));
+    }
+    return values;
+  }
+
+  batch W;
+  _batch_init(&W, D, keys);
+
+  bucket *B;
+  size_t hash;
+  for (int i = 0; i < n; i++) {
+    B = _batch_bucket(&W, i, &hash);
+    if (B != NULL) {
+      list_set(values, i, bucket_get(B, list_get(keys, i), hash));
+    }
+  }
+
+  return values;
+}
+
+list_t *dict_del_many(dict_t *D, list_t *keys) {
+  assert(D);
+  assert(keys);
+
+  size_t n = list_len(keys);
+  list_t *items = list_create(n);
+  if (n == 0) {
+    return items;
+  }
+  if (_dict_is_small(D)) {
+    for (int i = 0; i < n; i++) {
+      list_set(items, i, dict_del(D, list_get(keys, i)));
+    }
+    return items;
+  }
+
+  batch W;
+  _batch_init(&W, D, keys);
+
+  bucket *B;
+  item_t *I;
+  size_t hash;
+  for (int i = 0; i < n; i++) {
+    B = _batch_bucket(&W, i, &hash);
+    I = NULL;
+    if (B != NULL) {
+      I = bucket_del(B, list_get(keys, i), hash);
+    }
+    if (I != NULL) {
+      D->len--;
+    }
+    list_set(items, i, I);
+  }
+
+  // Shrink once for the whole batch.
+  _dict_resize(D, D->len);
+  return items;
+}
@@ -4,6 +4,7 @@
 #include "../include/test_utils.h"
 #include "../include/item.h"
 #include "../include/memory.h"
+#include "../include/list_extended.h"
 #include "../include/dict.h"
 #include "../include/dict_extended.h"
 
@@ -187,6 +188,259 @@ void test_big_dict() {
   dict_destroy(D);
 }
 
+void test_dict_iter() {
+  printf("dict iter\n");
+
+  dict_t *D = dict_create(int_eq, int_hash);
+  dict_iter_t It;
+  size_t num_bytes_used;
+
+  dict_iter_init(&It, D);
+  assert(dict_iter_next(&It) == false);
+
+  size_t N = 100;
+  for (int i = 0; i < N; i++) {
+    dict_set(D, int_wrap(i), int_wrap(2*i));
+  }
+
+  memory_count_reset();
+  size_t count = 0;
+  int key_sum = 0;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    assert(int_unwrap(dict_iter_value(&It)) == 2 * int_unwrap(dict_iter_key(&It)));
+    assert(dict_iter_key(&It) == item_get_key(dict_iter_item(&It)));
+    key_sum += int_unwrap(dict_iter_key(&It));
+    count++;
+  }
+  num_bytes_used = memory_count_report();
+  assert(count == N);
+  assert(key_sum == N * (N - 1) / 2);
+  assert(num_bytes_used == 0);
+
+  dict_total_destroy(D, memory_free, memory_free);
+}
+
+void test_dict_many() {
+  printf("dict many\n");
+
+  dict_t *D = dict_create(int_eq, int_hash);
+  list_t *keys = list_create(0);
+  list_t *values = list_create(0);
+  list_t *lookup;
+  list_t *actual_values;
+  list_t *items;
+  addr_t v;
+
+  size_t N = 100;
+  for (int i = 0; i < N; i++) {
+    list_push(keys, int_wrap(i));
+    list_push(values, int_wrap(2*i));
+  }
+
+  dict_set_many(D, keys, values);
+  assert(dict_len(D) == N);
+  for (int i = 0; i < N; i++) {
+    v = dict_get(D, list_get(keys, i));
+    assert(int_unwrap(v) == 2*i);
+  }
+
+  // Setting existing keys only replaces their values.
+  dict_set_many(D, keys, keys);
+  assert(dict_len(D) == N);
+
+  lookup = list_create(0);
+  for (int i = N - 10; i < N + 10; i++) {
+    list_push(lookup, int_wrap(i));
+  }
+
+  actual_values = dict_get_many(D, lookup);
+  assert(list_len(actual_values) == 20);
+  for (int i = 0; i < 20; i++) {
+    v = list_get(actual_values, i);
+    if (i < 10) {
+      assert(int_unwrap(v) == N - 10 + i);
+    } else {
+      assert(v == NULL);
+    }
+  }
+  list_destroy(actual_values);
+
+  items = dict_del_many(D, lookup);
+  assert(list_len(items) == 20);
+  assert(dict_len(D) == N - 10);
+  for (int i = 0; i < 20; i++) {
+    if (i < 10) {
+      assert(int_unwrap(item_get_key(list_get(items, i))) == N - 10 + i);
+      item_destroy(list_get(items, i));
+    } else {
+      assert(list_get(items, i) == NULL);
+    }
+  }
+  list_destroy(items);
+
+  items = dict_del_many(D, keys);
+  assert(dict_len(D) == 0);
+  for (int i = 0; i < N - 10; i++) {
+    item_destroy(list_get(items, i));
+  }
+  list_destroy(items);
+
+  dict_destroy(D);
+  list_total_destroy(lookup, memory_free);
+  list_total_destroy(keys, memory_free);
+  list_total_destroy(values, memory_free);
+}
+
+void test_dict_upsert() {
+  printf("dict upsert\n");
+
+  dict_t *D = dict_create(int_eq, int_hash);
+  addr_t k;
+  addr_t *slot;
+
+  // Count occurrences of i % 10.
+  for (int i = 0; i < 100; i++) {
+    k = int_wrap(i % 10);
+    slot = dict_upsert(D, k, int_increment);
+    if (int_unwrap(*slot) > 1) {
+      memory_free(k);
+    }
+  }
+  assert(dict_len(D) == 10);
+
+  for (int i = 0; i < 10; i++) {
+    k = int_wrap(i);
+    assert(int_unwrap(dict_get(D, k)) == 10);
+    memory_free(k);
+  }
+
+  k = int_wrap(3);
+  slot = dict_get_or_insert(D, k, NULL);
+  assert(int_unwrap(*slot) == 10);
+  *slot = int_increment(*slot);
+  assert(int_unwrap(dict_get(D, k)) == 11);
+  memory_free(k);
+
+  k = int_wrap(10);
+  slot = dict_get_or_insert(D, k, int_wrap(0));
+  assert(dict_len(D) == 11);
+  assert(int_unwrap(*slot) == 0);
+  assert(dict_get(D, k) == *slot);
+
+  dict_total_destroy(D, memory_free, memory_free);
+}
+
+size_t num_hash_calls = 0;
+size_t num_eq_calls = 0;
+
+size_t _counted_int_hash(addr_t e) {
+  num_hash_calls++;
+  return int_hash(e);
+}
+
+bool _counted_int_eq(addr_t e1, addr_t e2) {
+  num_eq_calls++;
+  return int_eq(e1, e2);
+}
+
+void test_small_dict() {
+  printf("small dict\n");
+
+  str_t actual;
+  addr_t k;
+  item_t *I;
+
+  // A small dict that never grew keeps its keys in insertion order.
+  dict_t *D = dict_create(int_eq, int_hash);
+  for (int i = 7; i >= 0; i--) {
+    dict_set(D, int_wrap(i), int_wrap(i * 10));
+  }
+  assert(dict_len(D) == 8);
+  actual = dict_string(D, int_str, int_str);
+  assert(strcmp(actual, "{7:70,6:60,5:50,4:40,3:30,2:20,1:10,0:0}") == 0);
+  memory_free(actual);
+
+  k = int_wrap(5);
+  I = dict_del(D, k);
+  assert(int_unwrap(item_get_key(I)) == 5);
+  item_total_destroy(I, memory_free, memory_free);
+  actual = dict_string(D, int_str, int_str);
+  assert(strcmp(actual, "{7:70,6:60,4:40,3:30,2:20,1:10,0:0}") == 0);
+  memory_free(actual);
+  memory_free(k);
+
+  // Growing past the small capacity and shrinking back keeps every key.
+  for (int i = 8; i < 100; i++) {
+    dict_set(D, int_wrap(i), int_wrap(i * 10));
+  }
+  assert(dict_len(D) == 99);
+  for (int i = 99; i >= 2; i--) {
+    k = int_wrap(i);
+    I = dict_del(D, k);
+    if (i == 5) {
+      assert(I == NULL);
+    } else {
+      item_total_destroy(I, memory_free, memory_free);
+    }
+    memory_free(k);
+  }
+  assert(dict_len(D) == 2);
+  for (int i = 0; i < 2; i++) {
+    k = int_wrap(i);
+    assert(int_unwrap(dict_get(D, k)) == i * 10);
+    memory_free(k);
+  }
+  dict_total_destroy(D, memory_free, memory_free);
+
+  // A tiny dict needs no allocations beyond the dict_t and its items.
+  memory_count_reset();
+  I = item_create(NULL, NULL);
+  size_t num_item_bytes = memory_count_report();
+  item_destroy(I);
+
+  D = dict_create(int_eq, int_hash);
+  memory_count_reset();
+  for (int i = 0; i < 4; i++) {
+    dict_set(D, int_wrap(i), int_wrap(i));
+  }
+  assert(memory_count_report() == 4 * (num_item_bytes + 2 * sizeof(int)));
+  dict_total_destroy(D, memory_free, memory_free);
+}
+
+void test_dict_cached_hash() {
+  printf("dict cached hash\n");
+
+  dict_t *D = dict_create(_counted_int_eq, _counted_int_hash);
+  addr_t k;
+
+  // Resizing reuses the cached hashes,
+  // so each insert hashes its key exactly once.
+  size_t N = 1000;
+  num_hash_calls = 0;
+  for (int i = 0; i < N; i++) {
+    dict_set(D, int_wrap(i), int_wrap(i));
+  }
+  assert(num_hash_calls == N);
+
+  // All hashes are distinct, so key_eq only runs on the matching key.
+  num_eq_calls = 0;
+  for (int i = 0; i < N; i++) {
+    k = int_wrap(i);
+    assert(int_unwrap(dict_get(D, k)) == i);
+    memory_free(k);
+  }
+  assert(num_eq_calls == N);
+
+  num_eq_calls = 0;
+  k = int_wrap(N);
+  assert(dict_get(D, k) == NULL);
+  memory_free(k);
+  assert(num_eq_calls == 0);
+
+  dict_total_destroy(D, memory_free, memory_free);
+}
+
 void test_dict_copy() {
   printf("dict_t copy\n");
 
@@ -303,6 +557,11 @@ int main() {
 
   test_basic_dict();
   test_big_dict();
+  test_dict_iter();
+  test_dict_many();
+  test_dict_upsert();
+  test_dict_cached_hash();
+  test_small_dict();
   test_dict_copy();
   test_dict_deep_copy();
 
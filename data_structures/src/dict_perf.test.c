@@ -4,7 +4,11 @@
 #include "../include/test_utils.h"
 #include "../include/item.h"
 #include "../include/memory.h"
+#include "../include/list_extended.h"
 #include "../include/dict.h"
+#include "../include/typed.h"
+
+DICT_DEFINE(int_dict, int, int, typed_hash_int, typed_eq_int)
 
 void test_dict_performance() {
   int MAG = 4;
@@ -54,8 +58,142 @@ void test_dict_performance() {
   }
 }
 
+void test_dict_many_performance() {
+  int MAG = 4;
+  dict_t *D;
+  list_t *keys;
+  list_t *values;
+  list_t *results;
+  size_t num_bytes_used;
+  clock_t start;
+  clock_t end;
+  double duration;
+
+  size_t N = 100000;
+
+  for (int i = 0; i < MAG; i++) {
+    keys = list_create(N);
+    values = list_create(N);
+    for (int i = 0; i < N; i++) {
+      list_set(keys, i, int_wrap(i));
+      list_set(values, i, int_wrap(2*i));
+    }
+
+    start = clock();
+    memory_count_reset();
+
+    D = dict_create(int_eq, int_hash);
+    dict_set_many(D, keys, values);
+    results = dict_get_many(D, keys);
+    list_destroy(results);
+    results = dict_del_many(D, keys);
+    for (int i = 0; i < N; i++) {
+      item_destroy(list_get(results, i));
+    }
+    list_destroy(results);
+    dict_destroy(D);
+
+    num_bytes_used = memory_count_report();
+    end = clock();
+
+    list_total_destroy(keys, memory_free);
+    list_total_destroy(values, memory_free);
+
+    duration = ((double) (end - start)) / CLOCKS_PER_SEC;
+    printf("# ITEMS (BATCH): %lu\n", N);
+    printf("SECS: %lf\n", duration);
+    printf("# BYTES: %lu\n", num_bytes_used);
+
+    N *= 2;
+  }
+}
+
+void test_typed_dict_performance() {
+  int MAG = 4;
+  int_dict_t *D;
+  int v;
+  size_t num_bytes_used;
+  clock_t start;
+  clock_t end;
+  double duration;
+
+  size_t N = 100000;
+
+  for (int i = 0; i < MAG; i++) {
+    start = clock();
+    memory_count_reset();
+
+    D = int_dict_create();
+    for (int i = 0; i < N; i++) {
+      int_dict_set(D, i, 2*i);
+    }
+    for (int i = 0; i < N; i++) {
+      int_dict_get(D, i, &v);
+    }
+    for (int i = 0; i < N; i++) {
+      int_dict_del(D, i, &v);
+    }
+    int_dict_destroy(D);
+
+    num_bytes_used = memory_count_report();
+    end = clock();
+
+    duration = ((double) (end - start)) / CLOCKS_PER_SEC;
+    printf("# ITEMS (TYPED): %lu\n", N);
+    printf("SECS: %lf\n", duration);
+    printf("# BYTES: %lu\n", num_bytes_used);
+
+    N *= 2;
+  }
+}
+
+// Time dict_set and dict_get with int_hash, which is the identity,
+// on sequential keys and on keys that are all multiples of 1024, whose
+// low bits are all equal. The bucket count is whatever dict_t grows to.
+void test_dict_clustered_keys_performance() {
+  size_t N = 1 << 20;
+  size_t R = 4;
+  size_t strides[] = {1, 1024};
+  dict_t *D;
+  list_t *keys;
+  clock_t start;
+  clock_t end;
+
+  for (int s = 0; s < 2; s++) {
+    keys = list_create(N);
+    for (int i = 0; i < N; i++) {
+      list_set(keys, i, int_wrap(i * strides[s]));
+    }
+
+    D = dict_create(int_eq, int_hash);
+    start = clock();
+    for (int i = 0; i < N; i++) {
+      dict_set(D, list_get(keys, i), list_get(keys, i));
+    }
+    end = clock();
+    printf("# SETS (STRIDE %lu): %lu\n", strides[s], N);
+    printf("NS PER SET: %lf\n", ((double) (end - start)) / CLOCKS_PER_SEC * 1e9 / N);
+
+    start = clock();
+    for (int r = 0; r < R; r++) {
+      for (int i = 0; i < N; i++) {
+        dict_get(D, list_get(keys, i));
+      }
+    }
+    end = clock();
+    printf("# GETS (STRIDE %lu): %lu\n", strides[s], N * R);
+    printf("NS PER GET: %lf\n", ((double) (end - start)) / CLOCKS_PER_SEC * 1e9 / (N * R));
+
+    dict_destroy(D);
+    list_total_destroy(keys, memory_free);
+  }
+}
+
 int main() {
   test_dict_performance();
+  test_dict_many_performance();
+  test_typed_dict_performance();
+  test_dict_clustered_keys_performance();
 
   return 0;
 }
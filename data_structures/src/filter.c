@@ -0,0 +1,411 @@
+#include <assert.h>
+#include <stdint.h>
+
+#include "../include/dict.h"
+#include "../include/hash.h"
+#include "../include/memory.h"
+#include "../include/set.h"
+#include "../include/filter.h"
+
+// Remix the entry's hash, so that the bits used by a filter
+// are independent of the bits used by the set or dict it fronts.
+const uint64_t FILTER_SEED = 0x9e3779b97f4a7c15ull;
+
+uint64_t _filter_mix(size_t hash) {
+  return hash_u64(hash ^ FILTER_SEED);
+}
+
+// Smallest k such that 2^-k <= fp_rate, at least 1 and at most max.
+size_t _filter_log_2_inverse(double fp_rate, size_t max) {
+  assert(fp_rate > 0 && fp_rate < 1);
+
+  size_t k = 1;
+  double p = 0.5;
+  while (p > fp_rate && k < max) {
+    p /= 2;
+    k++;
+  }
+  return k;
+}
+
+#define BLOOM_BLOCK_BITS 512
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+
+struct _impl_bloom_t {
+  size_t num_blocks;
+  // Number of bits set per entry.
+  size_t k;
+  uint64_t *words;
+  size_t (*hash) (addr_t e);
+};
+
+bloom_t *bloom_create(size_t n, double fp_rate, size_t (*hash) (addr_t e)) {
+  bloom_t *F = (bloom_t *) memory_malloc(sizeof(bloom_t));
+
+  // An optimal filter sets k = log2(1 / fp_rate) bits per entry
+  // and uses k / ln(2) ~ 1.44 k bits per entry.
+  // Blocking skews the load a little, so round that up to 1.5 k.
+  F->k = _filter_log_2_inverse(fp_rate, 16);
+  size_t num_bits = n * F->k * 3 / 2;
+  F->num_blocks = (num_bits + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+  if (F->num_blocks == 0) {
+    F->num_blocks = 1;
+  }
+  F->words = (uint64_t *) memory_calloc(F->num_blocks * BLOOM_BLOCK_WORDS, sizeof(uint64_t));
+  F->hash = hash;
+
+  return F;
+}
+
+void bloom_destroy(bloom_t *F) {
+  assert(F);
+
+  memory_free(F->words);
+  memory_free(F);
+}
+
+/* The high half of the hash picks the block,
+ * and the low half gives the k bits within it by double hashing.
+ */
+uint64_t *_bloom_block(bloom_t *F, uint64_t h) {
+  size_t block = (size_t) (((h >> 32) * F->num_blocks) >> 32);
+  return F->words + block * BLOOM_BLOCK_WORDS;
+}
+
+void bloom_add(bloom_t *F, addr_t e) {
+  assert(F);
+
+  uint64_t h = _filter_mix(F->hash(e));
+  uint64_t *block = _bloom_block(F, h);
+  uint32_t a = (uint32_t) h;
+  uint32_t b = (uint32_t) hash_u64(h) | 1;
+
+  size_t bit;
+  for (size_t i = 0; i < F->k; i++) {
+    bit = (a + i * b) % BLOOM_BLOCK_BITS;
+    block[bit / 64] |= (uint64_t) 1 << (bit % 64);
+  }
+}
+
+// h is the mixed hash of the entry.
+bool _bloom_may_include(bloom_t *F, uint64_t h) {
+  uint64_t *block = _bloom_block(F, h);
+  uint32_t a = (uint32_t) h;
+  uint32_t b = (uint32_t) hash_u64(h) | 1;
+
+  size_t bit;
+  for (size_t i = 0; i < F->k; i++) {
+    bit = (a + i * b) % BLOOM_BLOCK_BITS;
+    if (((block[bit / 64] >> (bit % 64)) & 1) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool bloom_may_include(bloom_t *F, addr_t e) {
+  assert(F);
+  return _bloom_may_include(F, _filter_mix(F->hash(e)));
+}
+
+/* Cuckoo filter with CUCKOO_BUCKET_SIZE fingerprints per bucket.
+ *
+ * An entry with fingerprint f lives in bucket i1 or i2 = i1 ^ hash(f),
+ * so either bucket can be found from the other without the entry.
+ * A fingerprint of 0 marks an empty slot.
+ * With b slots per bucket, the false positive rate is about 2b / 2^f
+ * for f-bit fingerprints.
+ */
+#define CUCKOO_BUCKET_SIZE 4
+#define CUCKOO_MAX_KICKS 500
+
+struct _impl_cuckoo_t {
+  size_t num_buckets;
+  uint16_t fingerprint_mask;
+  uint16_t *slots;
+  // The fingerprint left over when an add runs out of kicks,
+  // which is kept so that nothing added is ever lost.
+  uint16_t victim;
+  size_t victim_index;
+  uint64_t rng;
+  size_t (*hash) (addr_t e);
+};
+
+cuckoo_t *cuckoo_create(size_t n, double fp_rate, size_t (*hash) (addr_t e)) {
+  cuckoo_t *F = (cuckoo_t *) memory_malloc(sizeof(cuckoo_t));
+
+  size_t fingerprint_bits = _filter_log_2_inverse(fp_rate / (2 * CUCKOO_BUCKET_SIZE), 16);
+  F->fingerprint_mask = (uint16_t) ((1u << fingerprint_bits) - 1);
+
+  // Aim for buckets at most 90% full.
+  size_t min_buckets = n * 10 / (9 * CUCKOO_BUCKET_SIZE) + 1;
+  F->num_buckets = 1;
+  while (F->num_buckets < min_buckets) {
+    F->num_buckets *= 2;
+  }
+  F->slots = (uint16_t *) memory_calloc(F->num_buckets * CUCKOO_BUCKET_SIZE, sizeof(uint16_t));
+  F->victim = 0;
+  F->victim_index = 0;
+  F->rng = FILTER_SEED;
+  F->hash = hash;
+
+  return F;
+}
+
+void cuckoo_destroy(cuckoo_t *F) {
+  assert(F);
+
+  memory_free(F->slots);
+  memory_free(F);
+}
+
+// hash is the unmixed hash of the entry.
+void _cuckoo_locate(cuckoo_t *F, size_t hash, uint16_t *fp, size_t *i1, size_t *i2) {
+  uint64_t h = _filter_mix(hash);
+  *fp = (uint16_t) (h >> 32) & F->fingerprint_mask;
+  if (*fp == 0) {
+    *fp = 1;
+  }
+  *i1 = (size_t) h & (F->num_buckets - 1);
+  *i2 = (*i1 ^ hash_u64(*fp)) & (F->num_buckets - 1);
+}
+
+size_t _cuckoo_alt_index(cuckoo_t *F, size_t i, uint16_t fp) {
+  return (i ^ hash_u64(fp)) & (F->num_buckets - 1);
+}
+
+bool _cuckoo_bucket_insert(cuckoo_t *F, size_t i, uint16_t fp) {
+  uint16_t *bucket = F->slots + i * CUCKOO_BUCKET_SIZE;
+  for (int j = 0; j < CUCKOO_BUCKET_SIZE; j++) {
+    if (bucket[j] == 0) {
+      bucket[j] = fp;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool _cuckoo_bucket_includes(cuckoo_t *F, size_t i, uint16_t fp) {
+  uint16_t *bucket = F->slots + i * CUCKOO_BUCKET_SIZE;
+  for (int j = 0; j < CUCKOO_BUCKET_SIZE; j++) {
+    if (bucket[j] == fp) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool _cuckoo_bucket_remove(cuckoo_t *F, size_t i, uint16_t fp) {
+  uint16_t *bucket = F->slots + i * CUCKOO_BUCKET_SIZE;
+  for (int j = 0; j < CUCKOO_BUCKET_SIZE; j++) {
+    if (bucket[j] == fp) {
+      bucket[j] = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool cuckoo_add(cuckoo_t *F, addr_t e) {
+  assert(F);
+
+  if (F->victim != 0) {
+    return false;
+  }
+
+  uint16_t fp;
+  size_t i1;
+  size_t i2;
+  _cuckoo_locate(F, F->hash(e), &fp, &i1, &i2);
+  if (_cuckoo_bucket_insert(F, i1, fp) || _cuckoo_bucket_insert(F, i2, fp)) {
+    return true;
+  }
+
+  // Both buckets are full, so evict a random fingerprint
+  // to its other bucket, and so on.
+  size_t i = (F->rng & 1) ? i1 : i2;
+  size_t j;
+  uint16_t evicted;
+  for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+    F->rng ^= F->rng << 13;
+    F->rng ^= F->rng >> 7;
+    F->rng ^= F->rng << 17;
+    j = F->rng % CUCKOO_BUCKET_SIZE;
+
+    evicted = F->slots[i * CUCKOO_BUCKET_SIZE + j];
+    F->slots[i * CUCKOO_BUCKET_SIZE + j] = fp;
+    fp = evicted;
+
+    i = _cuckoo_alt_index(F, i, fp);
+    if (_cuckoo_bucket_insert(F, i, fp)) {
+      return true;
+    }
+  }
+
+  F->victim = fp;
+  F->victim_index = i;
+  return true;
+}
+
+bool _cuckoo_may_include(cuckoo_t *F, size_t hash) {
+  uint16_t fp;
+  size_t i1;
+  size_t i2;
+  _cuckoo_locate(F, hash, &fp, &i1, &i2);
+  if (_cuckoo_bucket_includes(F, i1, fp) || _cuckoo_bucket_includes(F, i2, fp)) {
+    return true;
+  }
+  return F->victim == fp && (F->victim_index == i1 || F->victim_index == i2);
+}
+
+bool cuckoo_may_include(cuckoo_t *F, addr_t e) {
+  assert(F);
+  return _cuckoo_may_include(F, F->hash(e));
+}
+
+bool cuckoo_remove(cuckoo_t *F, addr_t e) {
+  assert(F);
+
+  uint16_t fp;
+  size_t i1;
+  size_t i2;
+  _cuckoo_locate(F, F->hash(e), &fp, &i1, &i2);
+  if (F->victim == fp && (F->victim_index == i1 || F->victim_index == i2)) {
+    F->victim = 0;
+    return true;
+  }
+  if (!_cuckoo_bucket_remove(F, i1, fp) && !_cuckoo_bucket_remove(F, i2, fp)) {
+    return false;
+  }
+
+  // Make room for the victim again.
+  if (F->victim != 0 && _cuckoo_bucket_insert(F, F->victim_index, F->victim)) {
+    F->victim = 0;
+  }
+  return true;
+}
+
+bloom_t *bloom_from_set(set_t *S, double fp_rate) {
+  assert(S);
+
+  bloom_t *F = bloom_create(set_len(S), fp_rate, set_hash(S));
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    bloom_add(F, set_iter_entry(&It));
+  }
+  return F;
+}
+
+bloom_t *bloom_from_dict(dict_t *D, double fp_rate) {
+  assert(D);
+
+  bloom_t *F = bloom_create(dict_len(D), fp_rate, dict_key_hash(D));
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    bloom_add(F, dict_iter_key(&It));
+  }
+  return F;
+}
+
+bool bloom_set_includes(bloom_t *F, set_t *S, addr_t e) {
+  assert(F);
+  assert(S);
+  assert(F->hash == set_hash(S));
+
+  size_t hash = F->hash(e);
+  if (!_bloom_may_include(F, _filter_mix(hash))) {
+    return false;
+  }
+  return set_includes_hashed(S, e, hash);
+}
+
+addr_t bloom_dict_get(bloom_t *F, dict_t *D, addr_t k) {
+  assert(F);
+  assert(D);
+  assert(F->hash == dict_key_hash(D));
+
+  size_t hash = F->hash(k);
+  if (!_bloom_may_include(F, _filter_mix(hash))) {
+    return NULL;
+  }
+  return dict_get_hashed(D, k, hash);
+}
+
+/* A failed cuckoo_add would make the filter answer false for an entry
+ * of S or D, so start over with twice the room whenever one fails.
+ * Growing cannot help once more entries share a hash than fit in their
+ * two buckets, so give up after a few tries.
+ */
+#define CUCKOO_MAX_GROWS 4
+
+cuckoo_t *cuckoo_from_set(set_t *S, double fp_rate) {
+  assert(S);
+
+  size_t n = set_len(S);
+  cuckoo_t *F;
+  set_iter_t It;
+  bool ok;
+  for (int grows = 0; grows <= CUCKOO_MAX_GROWS; grows++) {
+    F = cuckoo_create(n, fp_rate, set_hash(S));
+    ok = true;
+    set_iter_init(&It, S);
+    while (ok && set_iter_next(&It)) {
+      ok = cuckoo_add(F, set_iter_entry(&It));
+    }
+    if (ok) {
+      return F;
+    }
+    cuckoo_destroy(F);
+    n *= 2;
+  }
+  return NULL;
+}
+
+cuckoo_t *cuckoo_from_dict(dict_t *D, double fp_rate) {
+  assert(D);
+
+  size_t n = dict_len(D);
+  cuckoo_t *F;
+  dict_iter_t It;
+  bool ok;
+  for (int grows = 0; grows <= CUCKOO_MAX_GROWS; grows++) {
+    F = cuckoo_create(n, fp_rate, dict_key_hash(D));
+    ok = true;
+    dict_iter_init(&It, D);
+    while (ok && dict_iter_next(&It)) {
+      ok = cuckoo_add(F, dict_iter_key(&It));
+    }
+    if (ok) {
+      return F;
+    }
+    cuckoo_destroy(F);
+    n *= 2;
+  }
+  return NULL;
+}
+
+bool cuckoo_set_includes(cuckoo_t *F, set_t *S, addr_t e) {
+  assert(F);
+  assert(S);
+  assert(F->hash == set_hash(S));
+
+  size_t hash = F->hash(e);
+  if (!_cuckoo_may_include(F, hash)) {
+    return false;
+  }
+  return set_includes_hashed(S, e, hash);
+}
+
+addr_t cuckoo_dict_get(cuckoo_t *F, dict_t *D, addr_t k) {
+  assert(F);
+  assert(D);
+  assert(F->hash == dict_key_hash(D));
+
+  size_t hash = F->hash(k);
+  if (!_cuckoo_may_include(F, hash)) {
+    return NULL;
+  }
+  return dict_get_hashed(D, k, hash);
+}
@@ -0,0 +1,183 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/hash.h"
+#include "../include/memory.h"
+#include "../include/dict_extended.h"
+#include "../include/set_extended.h"
+#include "../include/filter.h"
+
+void test_bloom() {
+  printf("bloom\n");
+
+  size_t N = 10000;
+  double fp_rate = 0.01;
+  addr_t e;
+
+  bloom_t *F = bloom_create(N, fp_rate, hash_int);
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    bloom_add(F, e);
+    memory_free(e);
+  }
+
+  // Never a false negative.
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    assert(bloom_may_include(F, e) == true);
+    memory_free(e);
+  }
+
+  // False positives stay close to the requested rate.
+  size_t num_false_positives = 0;
+  for (int i = N; i < 11 * N; i++) {
+    e = int_wrap(i);
+    if (bloom_may_include(F, e)) {
+      num_false_positives++;
+    }
+    memory_free(e);
+  }
+  assert(num_false_positives < 2 * fp_rate * 10 * N);
+
+  bloom_destroy(F);
+}
+
+void test_cuckoo() {
+  printf("cuckoo\n");
+
+  size_t N = 10000;
+  double fp_rate = 0.01;
+  addr_t e;
+
+  cuckoo_t *F = cuckoo_create(N, fp_rate, hash_int);
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    assert(cuckoo_add(F, e) == true);
+    memory_free(e);
+  }
+
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    assert(cuckoo_may_include(F, e) == true);
+    memory_free(e);
+  }
+
+  size_t num_false_positives = 0;
+  for (int i = N; i < 11 * N; i++) {
+    e = int_wrap(i);
+    if (cuckoo_may_include(F, e)) {
+      num_false_positives++;
+    }
+    memory_free(e);
+  }
+  assert(num_false_positives < 2 * fp_rate * 10 * N);
+
+  // Removing half keeps the other half.
+  for (int i = 0; i < N; i += 2) {
+    e = int_wrap(i);
+    assert(cuckoo_remove(F, e) == true);
+    memory_free(e);
+  }
+  num_false_positives = 0;
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    if (i % 2 == 1) {
+      assert(cuckoo_may_include(F, e) == true);
+    } else if (cuckoo_may_include(F, e)) {
+      num_false_positives++;
+    }
+    memory_free(e);
+  }
+  assert(num_false_positives < 2 * fp_rate * N);
+
+  // Overfilling is reported rather than losing entries.
+  cuckoo_t *G = cuckoo_create(10, fp_rate, hash_int);
+  int num_added = 0;
+  for (int i = 0; i < 1000; i++) {
+    e = int_wrap(i);
+    if (!cuckoo_add(G, e)) {
+      memory_free(e);
+      break;
+    }
+    num_added++;
+    memory_free(e);
+  }
+  assert(num_added < 1000);
+  for (int i = 0; i < num_added; i++) {
+    e = int_wrap(i);
+    assert(cuckoo_may_include(G, e) == true);
+    memory_free(e);
+  }
+
+  cuckoo_destroy(F);
+  cuckoo_destroy(G);
+}
+
+size_t _same_hash(addr_t e) {
+  return 42;
+}
+
+void test_filter_front_ends() {
+  printf("filter front ends\n");
+
+  size_t N = 1000;
+  addr_t e;
+
+  set_t *S = set_create(int_eq, hash_int);
+  dict_t *D = dict_create(int_eq, hash_int);
+  for (int i = 0; i < N; i++) {
+    set_add(S, int_wrap(i));
+    dict_set(D, int_wrap(i), int_wrap(2 * i));
+  }
+
+  bloom_t *BS = bloom_from_set(S, 0.01);
+  bloom_t *BD = bloom_from_dict(D, 0.01);
+  cuckoo_t *CS = cuckoo_from_set(S, 0.01);
+  cuckoo_t *CD = cuckoo_from_dict(D, 0.01);
+
+  for (int i = 0; i < 2 * N; i++) {
+    e = int_wrap(i);
+    assert(bloom_set_includes(BS, S, e) == (i < N));
+    assert(cuckoo_set_includes(CS, S, e) == (i < N));
+    if (i < N) {
+      assert(int_unwrap(bloom_dict_get(BD, D, e)) == 2 * i);
+      assert(int_unwrap(cuckoo_dict_get(CD, D, e)) == 2 * i);
+    } else {
+      assert(bloom_dict_get(BD, D, e) == NULL);
+      assert(cuckoo_dict_get(CD, D, e) == NULL);
+    }
+    memory_free(e);
+  }
+
+  bloom_destroy(BS);
+  bloom_destroy(BD);
+  cuckoo_destroy(CS);
+  cuckoo_destroy(CD);
+  set_total_destroy(S, memory_free);
+  dict_total_destroy(D, memory_free, memory_free);
+
+  // Entries that all share a hash do not fit in their two buckets,
+  // however large the filter grows.
+  S = set_create(int_eq, _same_hash);
+  for (int i = 0; i < 20; i++) {
+    set_add(S, int_wrap(i));
+  }
+  assert(cuckoo_from_set(S, 0.01) == NULL);
+  set_total_destroy(S, memory_free);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_bloom();
+  test_cuckoo();
+  test_filter_front_ends();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
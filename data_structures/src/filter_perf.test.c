@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/test_utils.h"
+#include "../include/hash.h"
+#include "../include/memory.h"
+#include "../include/list_extended.h"
+#include "../include/dict_extended.h"
+#include "../include/str.h"
+#include "../include/filter.h"
+
+bool _str_eq(addr_t s1, addr_t s2) {
+  return strcmp(str_unwrap(s1), str_unwrap(s2)) == 0;
+}
+
+// Time N lookups of keys in list L, directly and through each filter.
+void _report_lookups(str_t label, dict_t *D, bloom_t *B, cuckoo_t *C, list_t *L, size_t N) {
+  size_t num_found;
+  clock_t start;
+  clock_t end;
+
+  num_found = 0;
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    num_found += dict_get(D, list_get(L, i)) != NULL;
+  }
+  end = clock();
+  printf("SECS (%s, DICT): %lf\n", label, ((double) (end - start)) / CLOCKS_PER_SEC);
+
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    num_found += bloom_dict_get(B, D, list_get(L, i)) != NULL;
+  }
+  end = clock();
+  printf("SECS (%s, BLOOM): %lf\n", label, ((double) (end - start)) / CLOCKS_PER_SEC);
+
+  start = clock();
+  for (int i = 0; i < N; i++) {
+    num_found += cuckoo_dict_get(C, D, list_get(L, i)) != NULL;
+  }
+  end = clock();
+  printf("SECS (%s, CUCKOO): %lf\n", label, ((double) (end - start)) / CLOCKS_PER_SEC);
+  printf("# FOUND: %lu\n", num_found);
+}
+
+// Look up N keys that are all missing from a dict_t of N keys, and
+// then its N keys, directly and through each filter. Every key is its
+// own copy, as it would be when read from a request.
+void test_filter_performance() {
+  int MAG = 4;
+  dict_t *D;
+  list_t *hits;
+  list_t *misses;
+  bloom_t *B;
+  cuckoo_t *C;
+
+  size_t N = 1000000;
+
+  for (int i = 0; i < MAG; i++) {
+    D = dict_create(_str_eq, hash_str);
+    hits = list_create(N);
+    misses = list_create(N);
+    char buf[32];
+    for (int i = 0; i < N; i++) {
+      snprintf(buf, sizeof(buf), "session-%d", i);
+      dict_set(D, str_wrap(str_view_copy(str_view(buf))), int_wrap(i));
+      list_set(hits, i, str_wrap(str_view_copy(str_view(buf))));
+      snprintf(buf, sizeof(buf), "missing-%d", i);
+      list_set(misses, i, str_wrap(str_view_copy(str_view(buf))));
+    }
+    B = bloom_from_dict(D, 0.01);
+    C = cuckoo_from_dict(D, 0.01);
+
+    printf("# ITEMS: %lu\n", N);
+
+    _report_lookups("MISSES", D, B, C, misses, N);
+    _report_lookups("HITS", D, B, C, hits, N);
+
+    bloom_destroy(B);
+    cuckoo_destroy(C);
+    list_total_destroy(hits, str_destroy);
+    list_total_destroy(misses, str_destroy);
+    dict_total_destroy(D, str_destroy, memory_free);
+
+    N *= 2;
+  }
+}
+
+int main() {
+  test_filter_performance();
+
+  return 0;
+}
@@ -0,0 +1,280 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "../include/dict.h"
+#include "../include/hash.h"
+#include "../include/mapped_file.h"
+#include "../include/memory.h"
+#include "../include/snapshot.h"
+#include "../include/str.h"
+#include "../include/frozen_dict.h"
+
+/* Layout of a frozen dict file, in host byte order:
+ *
+ *   header
+ *   records     key_len, value_len (uint32_t each), key bytes, value bytes
+ *   padding     to a multiple of 8 bytes
+ *   slots       num_slots of (hash, offset) (uint64_t each)
+ *
+ * Slots form a linear-probing table that is at most half full, indexed
+ * by the low bits of the hash of the key bytes. offset is the position
+ * of a record from the start of the file, and is 0 for an empty slot,
+ * since no record starts inside the header. Nothing in the file is a
+ * pointer, so it can be mapped at any address.
+ *
+ * The records are written as the dict is walked, and the slots once
+ * every hash is known, and then the header, which needs the size of
+ * the records, is written over the space left for it.
+ */
+#define FROZEN_DICT_BUFFER_SIZE (1 << 16)
+
+const char FROZEN_DICT_MAGIC[4] = {'D', 'S', 'F', 'D'};
+const uint32_t FROZEN_DICT_VERSION = 1;
+const uint64_t FROZEN_DICT_SEED = 0x2d358dccaa6c78a5ull;
+
+struct _frozen_dict_header {
+  char magic[4];
+  uint32_t version;
+  uint64_t len;
+  uint64_t num_slots;
+  uint64_t slots_offset;
+  uint64_t seed;
+};
+typedef struct _frozen_dict_header header;
+
+struct _frozen_dict_slot {
+  uint64_t hash;
+  uint64_t offset;
+};
+typedef struct _frozen_dict_slot slot;
+
+struct _impl_frozen_dict_t {
+  mapped_file_t *M;
+  const char *data;
+  const header *H;
+  const slot *slots;
+  size_t mask;
+};
+
+bool _frozen_dict_write_all(int fd, const char *data, size_t n) {
+  ssize_t num_written;
+  while (n > 0) {
+    num_written = write(fd, data, n);
+    if (num_written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += num_written;
+    n -= num_written;
+  }
+  return true;
+}
+
+bool _frozen_dict_flush(int fd, str_buf_t *B) {
+  str_view_t V = str_buf_view(B);
+  bool ok = _frozen_dict_write_all(fd, V.data, V.len);
+  str_buf_clear(B);
+  return ok;
+}
+
+size_t _frozen_dict_num_slots(size_t len) {
+  size_t num_slots = 1;
+  while (num_slots < 2 * len) {
+    num_slots *= 2;
+  }
+  return num_slots;
+}
+
+bool frozen_dict_build(str_t path, dict_t *D, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec) {
+  assert(path);
+  assert(D);
+  assert(key_codec);
+  assert(value_codec);
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  size_t len = dict_len(D);
+  uint64_t *hashes = (uint64_t *) memory_malloc((len + 1) * sizeof(uint64_t));
+  uint64_t *offsets = (uint64_t *) memory_malloc((len + 1) * sizeof(uint64_t));
+  str_buf_t *B = str_buf_create(FROZEN_DICT_BUFFER_SIZE);
+  str_buf_t *K = str_buf_create(0);
+  str_buf_t *V = str_buf_create(0);
+  bool ok = true;
+
+  header H;
+  memset(&H, 0, sizeof(header));
+  str_buf_append_n(B, (const char *) &H, sizeof(header));
+  uint64_t offset = sizeof(header);
+
+  size_t i = 0;
+  str_view_t k;
+  str_view_t v;
+  uint32_t lens[2];
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    str_buf_clear(K);
+    str_buf_clear(V);
+    key_codec->encode(dict_iter_key(&It), K);
+    value_codec->encode(dict_iter_value(&It), V);
+    k = str_buf_view(K);
+    v = str_buf_view(V);
+    assert(k.len <= UINT32_MAX && v.len <= UINT32_MAX);
+
+    hashes[i] = hash_bytes(k.data, k.len, FROZEN_DICT_SEED);
+    offsets[i] = offset;
+    lens[0] = (uint32_t) k.len;
+    lens[1] = (uint32_t) v.len;
+    str_buf_append_n(B, (const char *) lens, sizeof(lens));
+    str_buf_append_view(B, k);
+    str_buf_append_view(B, v);
+    offset += sizeof(lens) + k.len + v.len;
+    i++;
+
+    if (ok && str_buf_len(B) >= FROZEN_DICT_BUFFER_SIZE) {
+      ok = _frozen_dict_flush(fd, B);
+    }
+  }
+  while (offset % sizeof(uint64_t) != 0) {
+    str_buf_append_char(B, '\0');
+    offset++;
+  }
+  if (ok) {
+    ok = _frozen_dict_flush(fd, B);
+  }
+
+  size_t num_slots = _frozen_dict_num_slots(len);
+  slot *slots = (slot *) memory_calloc(num_slots, sizeof(slot));
+  size_t mask = num_slots - 1;
+  size_t j;
+  for (i = 0; i < len; i++) {
+    j = hashes[i] & mask;
+    while (slots[j].offset != 0) {
+      j = (j + 1) & mask;
+    }
+    slots[j].hash = hashes[i];
+    slots[j].offset = offsets[i];
+  }
+  if (ok) {
+    ok = _frozen_dict_write_all(fd, (const char *) slots, num_slots * sizeof(slot));
+  }
+
+  memcpy(H.magic, FROZEN_DICT_MAGIC, sizeof(FROZEN_DICT_MAGIC));
+  H.version = FROZEN_DICT_VERSION;
+  H.len = len;
+  H.num_slots = num_slots;
+  H.slots_offset = offset;
+  H.seed = FROZEN_DICT_SEED;
+  if (ok) {
+    ok = pwrite(fd, &H, sizeof(header), 0) == sizeof(header);
+  }
+  if (close(fd) != 0) {
+    ok = false;
+  }
+
+  memory_free(slots);
+  memory_free(hashes);
+  memory_free(offsets);
+  str_buf_destroy(B);
+  str_buf_destroy(K);
+  str_buf_destroy(V);
+  return ok;
+}
+
+// Check that the header and slots of a mapped file fit in it.
+bool _frozen_dict_valid(str_view_t file) {
+  if (file.len < sizeof(header)) {
+    return false;
+  }
+  const header *H = (const header *) file.data;
+  if (memcmp(H->magic, FROZEN_DICT_MAGIC, sizeof(FROZEN_DICT_MAGIC)) != 0 || H->version != FROZEN_DICT_VERSION) {
+    return false;
+  }
+  if (H->num_slots == 0 || (H->num_slots & (H->num_slots - 1)) != 0 || H->len >= H->num_slots) {
+    return false;
+  }
+  if (H->slots_offset < sizeof(header) || H->slots_offset % sizeof(uint64_t) != 0 || H->slots_offset > file.len) {
+    return false;
+  }
+  return (file.len - H->slots_offset) / sizeof(slot) == H->num_slots;
+}
+
+frozen_dict_t *frozen_dict_open(str_t path) {
+  assert(path);
+
+  mapped_file_t *M = mapped_file_open(path, false);
+  if (M == NULL) {
+    return NULL;
+  }
+  str_view_t file = mapped_file_view(M);
+  if (!_frozen_dict_valid(file)) {
+    mapped_file_close(M);
+    return NULL;
+  }
+
+  frozen_dict_t *F = (frozen_dict_t *) memory_malloc(sizeof(frozen_dict_t));
+  F->M = M;
+  F->data = file.data;
+  F->H = (const header *) file.data;
+  F->slots = (const slot *) (file.data + F->H->slots_offset);
+  F->mask = F->H->num_slots - 1;
+  return F;
+}
+
+void frozen_dict_close(frozen_dict_t *F) {
+  assert(F);
+
+  mapped_file_close(F->M);
+  memory_free(F);
+}
+
+size_t frozen_dict_len(frozen_dict_t *F) {
+  assert(F);
+  return F->H->len;
+}
+
+/* Only the records of slots with the same hash are read, so a lookup
+ * usually touches one page of slots and one page of records.
+ */
+bool frozen_dict_get(frozen_dict_t *F, str_view_t key, str_view_t *value) {
+  assert(F);
+  assert(value);
+
+  uint64_t hash = hash_bytes(key.data, key.len, F->H->seed);
+  size_t j = hash & F->mask;
+  uint64_t records_end = F->H->slots_offset;
+  const slot *S;
+  const char *record;
+  uint32_t lens[2];
+  // A table that is at most half full ends every probe sequence
+  // long before this, unless the file is corrupt.
+  for (size_t num_probes = 0; num_probes <= F->mask; num_probes++) {
+    S = &F->slots[j];
+    if (S->offset == 0) {
+      return false;
+    }
+    // Subtract rather than add, so that a corrupt offset or length
+    // cannot wrap around and pass.
+    if (S->hash == hash && S->offset >= sizeof(header) && S->offset <= records_end - sizeof(lens)) {
+      record = F->data + S->offset;
+      memcpy(lens, record, sizeof(lens));
+      if (lens[0] == key.len
+          && lens[1] <= records_end - S->offset - sizeof(lens)
+          && lens[0] <= records_end - S->offset - sizeof(lens) - lens[1]
+          && memcmp(record + sizeof(lens), key.data, key.len) == 0) {
+        *value = str_view_n(record + sizeof(lens) + lens[0], lens[1]);
+        return true;
+      }
+    }
+    j = (j + 1) & F->mask;
+  }
+  return false;
+}
@@ -0,0 +1,209 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/hash.h"
+#include "../include/str.h"
+#include "../include/frozen_dict.h"
+
+bool _str_eq(addr_t s1, addr_t s2) {
+  return strcmp((str_t) s1, (str_t) s2) == 0;
+}
+
+size_t _str_hash(addr_t s) {
+  return hash_bytes(s, strlen((str_t) s), 0);
+}
+
+str_t FROZEN_DICT_PATH = "/tmp/frozen_dict.test";
+
+str_view_t _int_view(int *i) {
+  return str_view_n((const char *) i, sizeof(int));
+}
+
+void _dict_destroy_all(dict_t *D) {
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    memory_free(dict_iter_key(&It));
+    memory_free(dict_iter_value(&It));
+  }
+  dict_destroy(D);
+}
+
+void test_frozen_dict_get() {
+  printf("frozen dict get\n");
+
+  int N = 5000;
+  dict_t *D = dict_create(int_eq, int_hash);
+  addr_t k;
+  for (int i = 0; i < N; i++) {
+    k = int_wrap(i * 3);
+    dict_set(D, k, int_str(k));
+  }
+  assert(frozen_dict_build(FROZEN_DICT_PATH, D, &INT_CODEC, &STR_CODEC));
+
+  frozen_dict_t *F = frozen_dict_open(FROZEN_DICT_PATH);
+  assert(F);
+  assert(frozen_dict_len(F) == N);
+
+  str_view_t v;
+  int key;
+  for (int i = 0; i < 3 * N; i++) {
+    key = i;
+    if (i % 3 == 0) {
+      assert(frozen_dict_get(F, _int_view(&key), &v));
+      assert(str_view_eq(v, str_view(dict_get(D, &key))));
+    } else {
+      assert(!frozen_dict_get(F, _int_view(&key), &v));
+    }
+  }
+  frozen_dict_close(F);
+  _dict_destroy_all(D);
+  unlink(FROZEN_DICT_PATH);
+}
+
+void test_frozen_dict_strings() {
+  printf("frozen dict strings\n");
+
+  dict_t *D = dict_create(_str_eq, _str_hash);
+  str_t keys[] = {"GET /index.html", "POST /cart", "", "GET /checkout"};
+  str_t values[] = {"200", "", "400", "302"};
+  for (int i = 0; i < 4; i++) {
+    dict_set(D, keys[i], values[i]);
+  }
+  assert(frozen_dict_build(FROZEN_DICT_PATH, D, &STR_CODEC, &STR_CODEC));
+  dict_destroy(D);
+
+  frozen_dict_t *F = frozen_dict_open(FROZEN_DICT_PATH);
+  assert(F);
+  assert(frozen_dict_len(F) == 4);
+  str_view_t v;
+  for (int i = 0; i < 4; i++) {
+    assert(frozen_dict_get(F, str_view(keys[i]), &v));
+    assert(str_view_eq(v, str_view(values[i])));
+  }
+  assert(!frozen_dict_get(F, str_view("GET /index.htm"), &v));
+  assert(!frozen_dict_get(F, str_view("POST /cart "), &v));
+  frozen_dict_close(F);
+
+  D = dict_create(_str_eq, _str_hash);
+  assert(frozen_dict_build(FROZEN_DICT_PATH, D, &STR_CODEC, &STR_CODEC));
+  dict_destroy(D);
+  F = frozen_dict_open(FROZEN_DICT_PATH);
+  assert(F);
+  assert(frozen_dict_len(F) == 0);
+  assert(!frozen_dict_get(F, str_view(""), &v));
+  frozen_dict_close(F);
+  unlink(FROZEN_DICT_PATH);
+}
+
+/* Point every slot of the frozen dict at path to offset, or if offset
+ * is 0, give the record of every slot a value of value_len bytes.
+ * The header is a magic, a version, and then uint64_t len, num_slots
+ * and slots_offset, and each slot is a uint64_t hash and offset.
+ */
+void _corrupt_slots(str_t path, uint64_t offset, uint32_t value_len) {
+  int fd = open(path, O_RDWR);
+  assert(fd >= 0);
+  uint64_t num_slots;
+  uint64_t slots_offset;
+  uint64_t slot[2];
+  assert(pread(fd, &num_slots, sizeof(uint64_t), 16) == sizeof(uint64_t));
+  assert(pread(fd, &slots_offset, sizeof(uint64_t), 24) == sizeof(uint64_t));
+  for (uint64_t j = 0; j < num_slots; j++) {
+    assert(pread(fd, slot, sizeof(slot), slots_offset + j * sizeof(slot)) == sizeof(slot));
+    if (slot[1] == 0) {
+      continue;
+    }
+    if (offset != 0) {
+      slot[1] = offset;
+      assert(pwrite(fd, slot, sizeof(slot), slots_offset + j * sizeof(slot)) == sizeof(slot));
+    } else {
+      assert(pwrite(fd, &value_len, sizeof(uint32_t), slot[1] + sizeof(uint32_t)) == sizeof(uint32_t));
+    }
+  }
+  close(fd);
+}
+
+// Open the frozen dict at FROZEN_DICT_PATH, and check that none of
+// the keys of D can be found in it.
+void _assert_no_keys(dict_t *D) {
+  frozen_dict_t *F = frozen_dict_open(FROZEN_DICT_PATH);
+  assert(F);
+  str_view_t v;
+  int key;
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    key = int_unwrap(dict_iter_key(&It));
+    assert(!frozen_dict_get(F, _int_view(&key), &v));
+  }
+  frozen_dict_close(F);
+}
+
+void test_frozen_dict_errors() {
+  printf("frozen dict errors\n");
+
+  dict_t *D = dict_create(int_eq, int_hash);
+  addr_t k;
+  for (int i = 0; i < 100; i++) {
+    k = int_wrap(i);
+    dict_set(D, k, int_str(k));
+  }
+  assert(!frozen_dict_build("/tmp/frozen_dict.missing/test", D, &INT_CODEC, &STR_CODEC));
+  assert(frozen_dict_open("/tmp/frozen_dict.missing/test") == NULL);
+
+  // Cut short, so the slots do not fit.
+  assert(frozen_dict_build(FROZEN_DICT_PATH, D, &INT_CODEC, &STR_CODEC));
+  assert(truncate(FROZEN_DICT_PATH, 1000) == 0);
+  assert(frozen_dict_open(FROZEN_DICT_PATH) == NULL);
+  assert(truncate(FROZEN_DICT_PATH, 0) == 0);
+  assert(frozen_dict_open(FROZEN_DICT_PATH) == NULL);
+
+  // Not a frozen dict.
+  FILE *f = fopen(FROZEN_DICT_PATH, "w");
+  assert(f);
+  for (int i = 0; i < 100; i++) {
+    fprintf(f, "not a frozen dict\n");
+  }
+  fclose(f);
+  assert(frozen_dict_open(FROZEN_DICT_PATH) == NULL);
+
+  // Slots and records that point past the records, which must not be
+  // read from, however far past they point.
+  uint64_t bad_offsets[] = {UINT64_MAX - 3, UINT64_MAX, 1, 1 << 20};
+  uint32_t bad_lens[] = {UINT32_MAX, UINT32_MAX - 7, 1 << 20};
+  for (int i = 0; i < 4; i++) {
+    assert(frozen_dict_build(FROZEN_DICT_PATH, D, &INT_CODEC, &STR_CODEC));
+    _corrupt_slots(FROZEN_DICT_PATH, bad_offsets[i], 0);
+    _assert_no_keys(D);
+  }
+  for (int i = 0; i < 3; i++) {
+    assert(frozen_dict_build(FROZEN_DICT_PATH, D, &INT_CODEC, &STR_CODEC));
+    _corrupt_slots(FROZEN_DICT_PATH, 0, bad_lens[i]);
+    _assert_no_keys(D);
+  }
+
+  _dict_destroy_all(D);
+  unlink(FROZEN_DICT_PATH);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_frozen_dict_get();
+  test_frozen_dict_strings();
+  test_frozen_dict_errors();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
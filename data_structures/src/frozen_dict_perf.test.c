@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/str.h"
+#include "../include/snapshot.h"
+#include "../include/frozen_dict.h"
+
+double _secs(clock_t start, clock_t end) {
+  return ((double) (end - start)) / CLOCKS_PER_SEC;
+}
+
+void _dict_destroy_all(dict_t *D) {
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    memory_free(dict_iter_key(&It));
+    memory_free(dict_iter_value(&It));
+  }
+  dict_destroy(D);
+}
+
+// Time how long a dict of N items takes to become usable again,
+// by loading a snapshot of it and by opening a frozen dict of it,
+// and how fast each then answers N gets.
+void test_frozen_dict_startup_performance() {
+  int MAG = 3;
+  str_t snapshot_path = "/tmp/frozen_dict_perf.snapshot";
+  str_t frozen_path = "/tmp/frozen_dict_perf.frozen";
+  clock_t start;
+  clock_t end;
+  int fd;
+  size_t num_found;
+  str_view_t v;
+
+  size_t N = 1 << 19;
+
+  for (int i = 0; i < MAG; i++) {
+    printf("# ITEMS: %lu\n", N);
+
+    dict_t *D = dict_create(int_eq, int_hash);
+    addr_t k;
+    for (int j = 0; j < N; j++) {
+      k = int_wrap(j);
+      dict_set(D, k, int_wrap(j * 2));
+    }
+    fd = open(snapshot_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    assert(dict_save(fd, D, &INT_CODEC, &INT_CODEC));
+    close(fd);
+    assert(frozen_dict_build(frozen_path, D, &INT_CODEC, &INT_CODEC));
+    _dict_destroy_all(D);
+
+    start = clock();
+    fd = open(snapshot_path, O_RDONLY);
+    assert(fd >= 0);
+    D = dict_load(fd, int_eq, int_hash, &INT_CODEC, &INT_CODEC);
+    close(fd);
+    end = clock();
+    assert(D);
+    printf("SECS (SNAPSHOT LOAD): %lf\n", _secs(start, end));
+
+    start = clock();
+    frozen_dict_t *F = frozen_dict_open(frozen_path);
+    end = clock();
+    assert(F);
+    printf("SECS (FROZEN OPEN): %lf\n", _secs(start, end));
+
+    num_found = 0;
+    start = clock();
+    for (int j = 0; j < N; j++) {
+      if (dict_get(D, &j) != NULL) {
+        num_found++;
+      }
+    }
+    end = clock();
+    printf("SECS (DICT GET): %lf\n", _secs(start, end));
+    assert(num_found == N);
+
+    num_found = 0;
+    start = clock();
+    for (int j = 0; j < N; j++) {
+      if (frozen_dict_get(F, str_view_n((const char *) &j, sizeof(int)), &v)) {
+        num_found++;
+      }
+    }
+    end = clock();
+    printf("SECS (FROZEN GET): %lf\n", _secs(start, end));
+    assert(num_found == N);
+
+    frozen_dict_close(F);
+    _dict_destroy_all(D);
+    unlink(snapshot_path);
+    unlink(frozen_path);
+
+    N *= 2;
+  }
+}
+
+int main() {
+  test_frozen_dict_startup_performance();
+
+  return 0;
+}
@@ -0,0 +1,275 @@
+#include <assert.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../include/str.h"
+#include "../include/hash.h"
+
+const size_t HASH_LONG_LEN = 256;
+
+const uint64_t HASH_SECRET_0 = 0xa0761d6478bd642full;
+const uint64_t HASH_SECRET_1 = 0xe7037ed1a0b428dbull;
+const uint64_t HASH_SECRET_2 = 0x8ebc6af09c88c6e3ull;
+const uint64_t HASH_SECRET_3 = 0x589965cc75374cc3ull;
+
+const uint64_t HASH_PRIME_32 = 0x9e3779b1ull;
+
+/* Full 64 x 64 -> 128 bit multiply, returned as (lo, hi). */
+void _hash_mum(uint64_t *A, uint64_t *B) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t) *A * *B;
+  *A = (uint64_t) r;
+  *B = (uint64_t) (r >> 64);
+#else
+  uint64_t ha = *A >> 32;
+  uint64_t hb = *B >> 32;
+  uint64_t la = (uint32_t) *A;
+  uint64_t lb = (uint32_t) *B;
+  uint64_t rh = ha * hb;
+  uint64_t rm0 = ha * lb;
+  uint64_t rm1 = hb * la;
+  uint64_t rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  *A = lo;
+  *B = hi;
+#endif
+}
+
+uint64_t _hash_mix(uint64_t A, uint64_t B) {
+  _hash_mum(&A, &B);
+  return A ^ B;
+}
+
+uint64_t _hash_read_8(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint64_t _hash_read_4(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint64_t _hash_read_3(const uint8_t *p, size_t k) {
+  return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+size_t hash_combine(size_t h1, size_t h2) {
+  return (size_t) _hash_mix(h1 ^ HASH_SECRET_0, h2 ^ HASH_SECRET_1);
+}
+
+/* Short inputs: wyhash. */
+uint64_t _hash_short(const uint8_t *p, size_t len, uint64_t seed) {
+  uint64_t a;
+  uint64_t b;
+
+  seed ^= _hash_mix(seed ^ HASH_SECRET_0, HASH_SECRET_1);
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (_hash_read_4(p) << 32) | _hash_read_4(p + ((len >> 3) << 2));
+      b = (_hash_read_4(p + len - 4) << 32) | _hash_read_4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = _hash_read_3(p, len);
+      b = 0;
+    } else {
+      a = 0;
+      b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = _hash_mix(_hash_read_8(p) ^ HASH_SECRET_1, _hash_read_8(p + 8) ^ seed);
+        see1 = _hash_mix(_hash_read_8(p + 16) ^ HASH_SECRET_2, _hash_read_8(p + 24) ^ see1);
+        see2 = _hash_mix(_hash_read_8(p + 32) ^ HASH_SECRET_3, _hash_read_8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = _hash_mix(_hash_read_8(p) ^ HASH_SECRET_1, _hash_read_8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = _hash_read_8(p + i - 16);
+    b = _hash_read_8(p + i - 8);
+  }
+
+  a ^= HASH_SECRET_1;
+  b ^= seed;
+  _hash_mum(&a, &b);
+  return _hash_mix(a ^ HASH_SECRET_0 ^ len, b ^ HASH_SECRET_1);
+}
+
+/* Long inputs: 8 independent 64-bit lanes over 64-byte stripes.
+ *
+ * Each lane only needs a 32 x 32 -> 64 bit multiply and 64-bit adds,
+ * which map directly onto SSE2/AVX2, so the vector and scalar versions
+ * below compute exactly the same accumulators.
+ */
+#define HASH_LANES 8
+#define HASH_STRIPE_LEN 64
+#define HASH_STRIPES_PER_BLOCK 16
+
+void _hash_accumulate_scalar(uint64_t *acc, const uint8_t *p, const uint64_t *key) {
+  uint64_t d;
+  uint64_t dk;
+  for (int j = 0; j < HASH_LANES; j++) {
+    d = _hash_read_8(p + 8 * j);
+    dk = d ^ key[j];
+    acc[j ^ 1] += d;
+    acc[j] += (dk & 0xffffffffull) * (dk >> 32);
+  }
+}
+
+void _hash_scramble_scalar(uint64_t *acc, const uint64_t *key) {
+  for (int j = 0; j < HASH_LANES; j++) {
+    acc[j] ^= acc[j] >> 47;
+    acc[j] ^= key[j];
+    acc[j] *= HASH_PRIME_32;
+  }
+}
+
+#if defined(__AVX2__)
+void _hash_accumulate(uint64_t *acc, const uint8_t *p, const uint64_t *key) {
+  for (int j = 0; j < HASH_LANES; j += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *) (acc + j));
+    __m256i d = _mm256_loadu_si256((const __m256i *) (p + 8 * j));
+    __m256i k = _mm256_loadu_si256((const __m256i *) (key + j));
+    __m256i dk = _mm256_xor_si256(d, k);
+    __m256i product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+    __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+    a = _mm256_add_epi64(a, _mm256_add_epi64(product, swapped));
+    _mm256_storeu_si256((__m256i *) (acc + j), a);
+  }
+}
+
+void _hash_scramble(uint64_t *acc, const uint64_t *key) {
+  __m256i prime = _mm256_set1_epi32((int) HASH_PRIME_32);
+  for (int j = 0; j < HASH_LANES; j += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *) (acc + j));
+    __m256i k = _mm256_loadu_si256((const __m256i *) (key + j));
+    a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+    a = _mm256_xor_si256(a, k);
+    __m256i lo = _mm256_mul_epu32(a, prime);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+    a = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+    _mm256_storeu_si256((__m256i *) (acc + j), a);
+  }
+}
+#elif defined(__SSE2__)
+void _hash_accumulate(uint64_t *acc, const uint8_t *p, const uint64_t *key) {
+  for (int j = 0; j < HASH_LANES; j += 2) {
+    __m128i a = _mm_loadu_si128((const __m128i *) (acc + j));
+    __m128i d = _mm_loadu_si128((const __m128i *) (p + 8 * j));
+    __m128i k = _mm_loadu_si128((const __m128i *) (key + j));
+    __m128i dk = _mm_xor_si128(d, k);
+    __m128i product = _mm_mul_epu32(dk, _mm_srli_epi64(dk, 32));
+    __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+    a = _mm_add_epi64(a, _mm_add_epi64(product, swapped));
+    _mm_storeu_si128((__m128i *) (acc + j), a);
+  }
+}
+
+void _hash_scramble(uint64_t *acc, const uint64_t *key) {
+  __m128i prime = _mm_set1_epi32((int) HASH_PRIME_32);
+  for (int j = 0; j < HASH_LANES; j += 2) {
+    __m128i a = _mm_loadu_si128((const __m128i *) (acc + j));
+    __m128i k = _mm_loadu_si128((const __m128i *) (key + j));
+    a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+    a = _mm_xor_si128(a, k);
+    __m128i lo = _mm_mul_epu32(a, prime);
+    __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+    a = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    _mm_storeu_si128((__m128i *) (acc + j), a);
+  }
+}
+#else
+void _hash_accumulate(uint64_t *acc, const uint8_t *p, const uint64_t *key) {
+  _hash_accumulate_scalar(acc, p, key);
+}
+
+void _hash_scramble(uint64_t *acc, const uint64_t *key) {
+  _hash_scramble_scalar(acc, key);
+}
+#endif
+
+uint64_t _hash_long(
+    const uint8_t *p,
+    size_t len,
+    uint64_t seed,
+    void (*accumulate)(uint64_t *acc, const uint8_t *p, const uint64_t *key),
+    void (*scramble)(uint64_t *acc, const uint64_t *key)
+) {
+  assert(len >= HASH_STRIPE_LEN);
+
+  uint64_t key[HASH_LANES];
+  uint64_t acc[HASH_LANES];
+  const uint64_t secrets[4] = {HASH_SECRET_0, HASH_SECRET_1, HASH_SECRET_2, HASH_SECRET_3};
+  for (int j = 0; j < HASH_LANES; j++) {
+    key[j] = secrets[j % 4] ^ hash_u64(seed + j);
+    acc[j] = secrets[(j + 1) % 4];
+  }
+
+  size_t num_stripes = (len - 1) / HASH_STRIPE_LEN;
+  for (size_t s = 0; s < num_stripes; s++) {
+    accumulate(acc, p + s * HASH_STRIPE_LEN, key);
+    if (s % HASH_STRIPES_PER_BLOCK == HASH_STRIPES_PER_BLOCK - 1) {
+      scramble(acc, key);
+    }
+  }
+  // The last stripe ends exactly at the end of the input,
+  // overlapping the previous one if needed.
+  accumulate(acc, p + len - HASH_STRIPE_LEN, key);
+
+  uint64_t h = len * HASH_SECRET_0 ^ seed;
+  for (int j = 0; j < HASH_LANES; j += 2) {
+    h += _hash_mix(acc[j] ^ key[j], acc[j + 1] ^ key[j + 1]);
+  }
+  return _hash_mix(h ^ HASH_SECRET_2, HASH_SECRET_3);
+}
+
+size_t hash_bytes(const void *data, size_t len, uint64_t seed) {
+  assert(data || len == 0);
+
+  if (len <= HASH_LONG_LEN) {
+    return (size_t) _hash_short(data, len, seed);
+  }
+  return (size_t) _hash_long(data, len, seed, _hash_accumulate, _hash_scramble);
+}
+
+size_t hash_bytes_portable(const void *data, size_t len, uint64_t seed) {
+  assert(data || len == 0);
+
+  if (len <= HASH_LONG_LEN) {
+    return (size_t) _hash_short(data, len, seed);
+  }
+  return (size_t) _hash_long(data, len, seed, _hash_accumulate_scalar, _hash_scramble_scalar);
+}
+
+size_t hash_int(addr_t e) {
+  assert(e);
+
+  int i = *((int *) e);
+  return hash_u64((uint64_t) (int64_t) i);
+}
+
+size_t hash_ptr(addr_t e) {
+  return hash_u64((uint64_t) (uintptr_t) e);
+}
+
+size_t hash_str(addr_t e) {
+  str_t s = str_unwrap(e);
+  return hash_bytes(s, strlen(s), 0);
+}
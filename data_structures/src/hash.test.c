@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/str.h"
+#include "../include/hash.h"
+
+void test_hash_deterministic() {
+  printf("hash deterministic\n");
+
+  addr_t e1 = int_wrap(42);
+  addr_t e2 = int_wrap(42);
+  assert(hash_int(e1) == hash_int(e2));
+  assert(hash_int(e1) != hash_u64(43));
+  memory_free(e1);
+  memory_free(e2);
+
+  addr_t s1 = str_wrap("hello world");
+  addr_t s2 = str_wrap("hello world");
+  assert(hash_str(s1) == hash_str(s2));
+  assert(hash_str(s1) == hash_bytes("hello world", 11, 0));
+  assert(hash_bytes("hello world", 11, 0) != hash_bytes("hello world", 11, 1));
+  assert(hash_bytes("hello world", 11, 0) != hash_bytes("hello worle", 11, 0));
+  assert(hash_bytes("", 0, 0) != hash_bytes("", 0, 1));
+  memory_free(s1);
+  memory_free(s2);
+
+  int x;
+  assert(hash_ptr(&x) == hash_ptr(&x));
+  assert(hash_combine(1, 2) != hash_combine(2, 1));
+}
+
+void test_hash_simd_matches_portable() {
+  printf("hash simd matches portable\n");
+
+  size_t max_len = 4 * 1024 + 3;
+  char *buffer = (char *) memory_malloc(max_len);
+  for (size_t i = 0; i < max_len; i++) {
+    buffer[i] = (char) (i * 31 + 7);
+  }
+
+  for (size_t len = 0; len <= max_len; len += 1 + len / 16) {
+    assert(hash_bytes(buffer, len, 0) == hash_bytes_portable(buffer, len, 0));
+    assert(hash_bytes(buffer, len, 99) == hash_bytes_portable(buffer, len, 99));
+  }
+
+  // Every byte of a long input matters.
+  size_t h = hash_bytes(buffer, max_len, 0);
+  for (size_t i = 0; i < max_len; i += 97) {
+    buffer[i] ^= 1;
+    assert(hash_bytes(buffer, max_len, 0) != h);
+    buffer[i] ^= 1;
+  }
+
+  memory_free(buffer);
+}
+
+void test_hash_low_bits() {
+  printf("hash low bits\n");
+
+  // Keys that share their low bits must still spread over
+  // all buckets when indexed by the low bits of the hash.
+  size_t num_buckets = 256;
+  size_t counts[256] = {0};
+  addr_t e;
+  for (int i = 0; i < 16 * num_buckets; i++) {
+    e = int_wrap(i * 1024);
+    counts[hash_int(e) % num_buckets]++;
+    memory_free(e);
+  }
+
+  size_t max_load = 0;
+  for (size_t i = 0; i < num_buckets; i++) {
+    assert(counts[i] > 0);
+    if (counts[i] > max_load) {
+      max_load = counts[i];
+    }
+  }
+  // Expected load is 16.
+  assert(max_load < 48);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_hash_deterministic();
+  test_hash_simd_matches_portable();
+  test_hash_low_bits();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/test_utils.h"
+#include "../include/item.h"
+#include "../include/memory.h"
+#include "../include/list_extended.h"
+#include "../include/dict.h"
+#include "../include/dict_extended.h"
+#include "../include/hash.h"
+
+size_t piece_hash_combined(addr_t p) {
+  return hash_combine(hash_u64(((piece_t *) p)->first), hash_u64(((piece_t *) p)->second));
+}
+
+// Print how evenly counts spreads n keys over num_buckets buckets.
+void _report_counts(str_t how, size_t *counts, size_t n, size_t num_buckets) {
+  size_t empty = 0;
+  size_t max_load = 0;
+  double expected = (double) n / num_buckets;
+  double chi_squared = 0;
+  for (int i = 0; i < num_buckets; i++) {
+    if (counts[i] == 0) {
+      empty++;
+    }
+    if (counts[i] > max_load) {
+      max_load = counts[i];
+    }
+    chi_squared += (counts[i] - expected) * (counts[i] - expected) / expected;
+  }
+
+  printf("EMPTY BUCKETS (%s): %lu / %lu\n", how, empty, num_buckets);
+  printf("MAX LOAD (%s): %lu (EXPECTED %.1lf)\n", how, max_load, expected);
+  // Close to num_buckets for a uniform hash.
+  printf("CHI SQUARED (%s): %.1lf\n", how, chi_squared);
+}
+
+// Report how keys land in num_buckets buckets, both by the low bits
+// of their hash, which shows how well the hash itself spreads them,
+// and under hash_slot, which is how dict_t and set_t pick a slot.
+// num_buckets must be a power of two.
+void report_distribution(str_t name, list_t *keys, size_t (*hash)(addr_t e), size_t num_buckets) {
+  size_t *low_bits = (size_t *) memory_calloc(num_buckets, sizeof(size_t));
+  size_t *slots = (size_t *) memory_calloc(num_buckets, sizeof(size_t));
+  size_t n = list_len(keys);
+  size_t h;
+  for (int i = 0; i < n; i++) {
+    h = hash(list_get(keys, i));
+    low_bits[h & (num_buckets - 1)]++;
+    slots[hash_slot(h, num_buckets)]++;
+  }
+
+  printf("%s\n", name);
+  _report_counts("LOW BITS", low_bits, n, num_buckets);
+  _report_counts("HASH SLOT", slots, n, num_buckets);
+  memory_free(low_bits);
+  memory_free(slots);
+}
+
+double time_dict(list_t *keys, bool (*eq)(addr_t e1, addr_t e2), size_t (*hash)(addr_t e)) {
+  clock_t start = clock();
+
+  dict_t *D = dict_create(eq, hash);
+  for (int i = 0; i < list_len(keys); i++) {
+    dict_set(D, list_get(keys, i), list_get(keys, i));
+  }
+  for (int i = 0; i < list_len(keys); i++) {
+    dict_get(D, list_get(keys, i));
+  }
+  dict_destroy(D);
+
+  clock_t end = clock();
+  return ((double) (end - start)) / CLOCKS_PER_SEC;
+}
+
+void test_hash_distribution() {
+  size_t N = 1 << 16;
+  size_t num_buckets = 1 << 16;
+  int strides[] = {1, 64, 1024};
+  char label[64];
+  list_t *keys;
+
+  for (int s = 0; s < 3; s++) {
+    keys = list_create(N);
+    for (int i = 0; i < N; i++) {
+      list_set(keys, i, int_wrap(i * strides[s]));
+    }
+
+    printf("# INTS WITH STRIDE: %d\n", strides[s]);
+    snprintf(label, sizeof(label), "int_hash");
+    report_distribution(label, keys, int_hash, num_buckets);
+    printf("DICT SECS: %lf\n", time_dict(keys, int_eq, int_hash));
+    snprintf(label, sizeof(label), "hash_int");
+    report_distribution(label, keys, hash_int, num_buckets);
+    printf("DICT SECS: %lf\n", time_dict(keys, int_eq, hash_int));
+
+    list_total_destroy(keys, memory_free);
+  }
+
+  keys = list_create(0);
+  for (char c = 'a'; c <= 'z'; c++) {
+    for (int i = 0; i < 2048; i++) {
+      list_push(keys, piece_create(c, i));
+    }
+  }
+  printf("# PIECES: %lu\n", list_len(keys));
+  report_distribution("piece_hash", keys, piece_hash, num_buckets);
+  printf("DICT SECS: %lf\n", time_dict(keys, piece_eq, piece_hash));
+  report_distribution("piece_hash_combined", keys, piece_hash_combined, num_buckets);
+  printf("DICT SECS: %lf\n", time_dict(keys, piece_eq, piece_hash_combined));
+  list_total_destroy(keys, memory_free);
+}
+
+void test_hash_throughput() {
+  int MAG = 4;
+  size_t len = 64;
+  size_t total = 1 << 28;
+  clock_t start;
+  clock_t end;
+  double simd;
+  double portable;
+  size_t sink = 0;
+
+  char *buffer = (char *) memory_malloc(1 << 20);
+  for (size_t i = 0; i < 1 << 20; i++) {
+    buffer[i] = (char) i;
+  }
+
+  for (int m = 0; m < MAG; m++) {
+    start = clock();
+    for (size_t done = 0; done < total; done += len) {
+      sink += hash_bytes(buffer, len, sink);
+    }
+    end = clock();
+    simd = ((double) (end - start)) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (size_t done = 0; done < total; done += len) {
+      sink += hash_bytes_portable(buffer, len, sink);
+    }
+    end = clock();
+    portable = ((double) (end - start)) / CLOCKS_PER_SEC;
+
+    printf("# BYTES PER KEY: %lu\n", len);
+    printf("MB/S: %.0lf\n", total / simd / (1 << 20));
+    printf("MB/S (PORTABLE): %.0lf\n", total / portable / (1 << 20));
+
+    len *= 16;
+  }
+
+  memory_free(buffer);
+  if (sink == 0) {
+    printf("\n");
+  }
+}
+
+int main() {
+  test_hash_distribution();
+  test_hash_throughput();
+
+  return 0;
+}
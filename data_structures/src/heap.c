@@ -7,6 +7,7 @@
 #include "../include/list.h"
 #include "../include/list_extended.h"
 #include "../include/memory.h"
+#include "../include/str.h"
 #include "../include/heap.h"
 
 // A Fibonnaci heap_t has the following optimal running-times:
@@ -202,68 +203,43 @@ void _heap_node_destroy(heap_node_t *N) {
   memory_free(N);
 }
 
-size_t TEMP_MAX_STR_SIZE = 50;
-size_t HEAP_MAX_STR_SIZE = 1000;
-
-void _print_indent(str_t res, size_t indent_level) {
+void _print_indent(str_buf_t *B, size_t indent_level) {
   for (int i = 0; i < indent_level; i++) {
-    strncat(res, "\t", 1);
+    str_buf_append_char(B, '\t');
   }
 }
 
 void _print_heap_node(
-  str_t res,
-  str_t temp,
+  str_buf_t *B,
   size_t indent_level,
   heap_node_t *N,
   str_t (*key_string)(addr_t k),
   str_t (*value_string)(addr_t v)
 ) {
-  size_t temp_len;
-
-  _print_indent(res, indent_level);
-  temp_len = 8 + PTR_MAX_STR_SIZE + 1;
-  snprintf(temp, temp_len, "heap_node: %p\n", N);
-  strncat(res, temp, temp_len);
+  _print_indent(B, indent_level);
+  str_buf_appendf(B, "heap_node: %p\n", N);
 
   item_t *I = N->I;
   assert(I);
-  addr_t k = item_get_key(I);
-  addr_t v = item_get_value(I);
-  str_t k_str = key_string(k);
-  str_t v_str = value_string(v);
-  size_t k_len = strlen(k_str);
-  size_t v_len = strlen(v_str);
-  _print_indent(res, indent_level);
-  strncat(res, k_str, k_len);
-  strncat(res, ":", 1);
-  strncat(res, v_str, v_len);
-  strncat(res, "\n", 1);
-
-  _print_indent(res, indent_level);
-  temp_len = 6 + 1 + 1;
-  snprintf(temp, temp_len, "mark: %d\n", N->mark);
-  strncat(res, temp, temp_len);
-
-  _print_indent(res, indent_level);
-  temp_len = 8 + LU_MAX_STR_SIZE + 1;
-  snprintf(temp, temp_len, "degree: %lu\n", N->degree);
-  strncat(res, temp, temp_len);
-
-  _print_indent(res, indent_level);
-  temp_len = 8 + PTR_MAX_STR_SIZE + 1;
-  snprintf(temp, temp_len, "parent: %p\n", N->parent);
-  strncat(res, temp, temp_len);
-
-  _print_indent(res, indent_level);
-  temp_len = 22 + PTR_MAX_STR_SIZE + 1;
-  snprintf(temp, temp_len, "parent_children_link: %p\n", N->parent_children_link);
-  strncat(res, temp, temp_len);
-
-  strncat(res, "\n", 1);
-
-  memory_free(k_str);
-  memory_free(v_str);
+  _print_indent(B, indent_level);
+  str_buf_append_owned(B, key_string(item_get_key(I)));
+  str_buf_append_char(B, ':');
+  str_buf_append_owned(B, value_string(item_get_value(I)));
+  str_buf_append_char(B, '\n');
+
+  _print_indent(B, indent_level);
+  str_buf_appendf(B, "mark: %d\n", N->mark);
+
+  _print_indent(B, indent_level);
+  str_buf_appendf(B, "degree: %lu\n", N->degree);
+
+  _print_indent(B, indent_level);
+  str_buf_appendf(B, "parent: %p\n", N->parent);
+
+  _print_indent(B, indent_level);
+  str_buf_appendf(B, "parent_children_link: %p\n", N->parent_children_link);
+
+  str_buf_append_char(B, '\n');
 }
 
 struct _impl_heap_t {
@@ -364,6 +340,29 @@ void heap_iterator_destroy(list_t *iterator) {
   list_destroy(iterator);
 }
 
+void _heap_items_helper(list_t *L, linked_list_t *ring) {
+  link_t *curr = ring->join;
+  if (curr == NULL) {
+    return;
+  }
+
+  heap_node_t *N;
+  do {
+    N = (heap_node_t *) curr->value;
+    list_push(L, N->I);
+    _heap_items_helper(L, N->children);
+    curr = curr->next;
+  } while (curr != ring->join);
+}
+
+list_t *heap_items(heap_t *H) {
+  assert(H);
+
+  list_t *L = list_create(0);
+  _heap_items_helper(L, H->forest);
+  return L;
+}
+
 item_t *heap_peek_min(heap_t *H) {
   assert(H);
 
@@ -585,8 +584,7 @@ heap_t *heap_meld(
 
 // DFS-traversal of nodes.
 void _heap_string_helper(
-  str_t res,
-  str_t temp,
+  str_buf_t *B,
   size_t indent_level,
   linked_list_t *ring,
   str_t (*key_string)(addr_t k),
@@ -601,8 +599,8 @@ void _heap_string_helper(
 
   do {
     N = (heap_node_t *) curr->value;
-    _print_heap_node(res, temp, indent_level, N, key_string, value_string);
-    _heap_string_helper(res, temp, indent_level+1, N->children, key_string, value_string);
+    _print_heap_node(B, indent_level, N, key_string, value_string);
+    _heap_string_helper(B, indent_level+1, N->children, key_string, value_string);
 
     curr = curr->next;
   } while (curr != ring->join);
@@ -611,11 +609,9 @@ void _heap_string_helper(
 str_t heap_string(heap_t *H, str_t (*key_string)(addr_t k), str_t (*value_string)(addr_t v)) {
   assert(H);
 
-  str_t res = (str_t) memory_calloc(HEAP_MAX_STR_SIZE, sizeof(char));
-  str_t temp = memory_calloc(TEMP_MAX_STR_SIZE, sizeof(char));
-  strncat(res, "<\n", 2);
-  _heap_string_helper(res, temp, 1, H->forest, key_string, value_string);
-  strncat(res, ">\n", 2);
-  memory_free(temp);
-  return res;
+  str_buf_t *B = str_buf_create(0);
+  str_buf_append_n(B, "<\n", 2);
+  _heap_string_helper(B, 1, H->forest, key_string, value_string);
+  str_buf_append_n(B, ">\n", 2);
+  return str_buf_finish(B);
 }
@@ -0,0 +1,135 @@
+#include <assert.h>
+
+#include "../include/dict.h"
+#include "../include/hash.h"
+#include "../include/memory.h"
+#include "../include/str.h"
+#include "../include/intern.h"
+
+/* Every interned string is stored right after its entry, in a single
+ * allocation, so that the hash and length of an interned string can
+ * be found from the string itself.
+ * The table is a dict_t from entries to themselves. Lookups use an
+ * entry on the stack whose data points into the caller's string.
+ */
+struct _intern_entry {
+  size_t hash;
+  size_t len;
+  const char *data;
+};
+typedef struct _intern_entry entry_t;
+
+const uint64_t INTERN_SEED = 0x1f83d9abfb41bd6bull;
+
+struct _impl_intern_t {
+  dict_t *D;
+  size_t num_bytes;
+  size_t num_hits;
+  size_t num_bytes_saved;
+};
+
+bool _intern_entry_eq(addr_t e1, addr_t e2) {
+  entry_t *E1 = (entry_t *) e1;
+  entry_t *E2 = (entry_t *) e2;
+  return E1->hash == E2->hash && E1->len == E2->len && memcmp(E1->data, E2->data, E1->len) == 0;
+}
+
+size_t _intern_entry_hash(addr_t e) {
+  return ((entry_t *) e)->hash;
+}
+
+entry_t *_intern_entry_of(addr_t s) {
+  return (entry_t *) ((char *) s - sizeof(entry_t));
+}
+
+intern_t *intern_create() {
+  intern_t *T = (intern_t *) memory_malloc(sizeof(intern_t));
+
+  T->D = dict_create(_intern_entry_eq, _intern_entry_hash);
+  T->num_bytes = 0;
+  T->num_hits = 0;
+  T->num_bytes_saved = 0;
+
+  return T;
+}
+
+void intern_destroy(intern_t *T) {
+  assert(T);
+
+  dict_iter_t It;
+  dict_iter_init(&It, T->D);
+  while (dict_iter_next(&It)) {
+    memory_free(dict_iter_key(&It));
+  }
+  dict_destroy(T->D);
+  memory_free(T);
+}
+
+size_t intern_len(intern_t *T) {
+  assert(T);
+  return dict_len(T->D);
+}
+
+str_t intern_get(intern_t *T, str_view_t V) {
+  assert(T);
+
+  entry_t probe = {hash_bytes(V.data, V.len, INTERN_SEED), V.len, V.data};
+  entry_t *E = (entry_t *) dict_get(T->D, &probe);
+  if (E == NULL) {
+    return NULL;
+  }
+  return (str_t) E->data;
+}
+
+str_t intern_view(intern_t *T, str_view_t V) {
+  assert(T);
+
+  entry_t probe = {hash_bytes(V.data, V.len, INTERN_SEED), V.len, V.data};
+  entry_t *E = (entry_t *) dict_get(T->D, &probe);
+  if (E != NULL) {
+    T->num_hits++;
+    T->num_bytes_saved += V.len + 1;
+    return (str_t) E->data;
+  }
+
+  size_t num_bytes = sizeof(entry_t) + V.len + 1;
+  E = (entry_t *) memory_malloc(num_bytes);
+  str_t s = (str_t) (E + 1);
+  memcpy(s, V.data, V.len);
+  s[V.len] = '\0';
+  E->hash = probe.hash;
+  E->len = V.len;
+  E->data = s;
+  dict_set(T->D, E, E);
+  T->num_bytes += num_bytes;
+  return s;
+}
+
+str_t intern_str(intern_t *T, str_t s) {
+  assert(s);
+  return intern_view(T, str_view(s));
+}
+
+bool intern_eq(addr_t s1, addr_t s2) {
+  return s1 == s2;
+}
+
+size_t intern_hash(addr_t s) {
+  assert(s);
+  return _intern_entry_of(s)->hash;
+}
+
+size_t intern_str_len(addr_t s) {
+  assert(s);
+  return _intern_entry_of(s)->len;
+}
+
+void intern_stats(intern_t *T, intern_stats_t *stats) {
+  assert(T);
+  assert(stats);
+
+  stats->len = dict_len(T->D);
+  stats->num_bytes = T->num_bytes;
+  stats->num_hits = T->num_hits;
+  stats->num_bytes_saved = T->num_bytes_saved;
+}
@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/dict.h"
+#include "../include/str.h"
+#include "../include/intern.h"
+
+void test_intern_basic() {
+  printf("intern basic\n");
+
+  intern_t *T = intern_create();
+  assert(intern_len(T) == 0);
+
+  char buf[] = "checkout";
+  str_t s1 = intern_str(T, buf);
+  assert(s1 != buf);
+  assert(strcmp(s1, "checkout") == 0);
+  assert(intern_len(T) == 1);
+
+  // The caller's string can change without affecting the copy.
+  buf[0] = 'C';
+  str_t s2 = intern_str(T, "checkout");
+  assert(s2 == s1);
+  assert(intern_len(T) == 1);
+
+  str_t s3 = intern_view(T, str_view_n("checkout-service", 8));
+  assert(s3 == s1);
+  assert(intern_str_len(s3) == 8);
+
+  str_t s4 = intern_str(T, "");
+  assert(strcmp(s4, "") == 0);
+  assert(s4 != s1);
+  assert(intern_len(T) == 2);
+
+  assert(intern_get(T, str_view("checkout")) == s1);
+  assert(intern_get(T, str_view("cart")) == NULL);
+  assert(intern_len(T) == 2);
+
+  assert(intern_eq(s1, s2));
+  assert(!intern_eq(s1, s4));
+  assert(intern_hash(s1) == intern_hash(s3));
+
+  intern_destroy(T);
+}
+
+// Key a dict_t by interned tokens, without allocating a string per token.
+void test_intern_dict_keys() {
+  printf("intern dict keys\n");
+
+  str_t log = "cart checkout cart search cart checkout search cart";
+
+  intern_t *T = intern_create();
+  dict_t *D = dict_create(intern_eq, intern_hash);
+
+  str_t k;
+  int *count;
+  str_split_iter_t It;
+  str_split_iter_init(&It, str_view(log), str_view(" "));
+  while (str_split_iter_next(&It)) {
+    k = intern_view(T, str_split_iter_token(&It));
+    count = (int *) dict_get(D, k);
+    if (count == NULL) {
+      dict_set(D, k, int_wrap(1));
+    } else {
+      (*count)++;
+    }
+  }
+  assert(intern_len(T) == 3);
+  assert(dict_len(D) == 3);
+  assert(int_unwrap(dict_get(D, intern_str(T, "cart"))) == 4);
+  assert(int_unwrap(dict_get(D, intern_str(T, "checkout"))) == 2);
+  assert(int_unwrap(dict_get(D, intern_str(T, "search"))) == 2);
+
+  intern_stats_t stats;
+  intern_stats(T, &stats);
+  assert(stats.len == 3);
+  assert(stats.num_hits == 5 + 3);
+  // 3 hits on "cart", 1 on "checkout", 1 on "search",
+  // then 1 each on "cart", "checkout" and "search".
+  assert(stats.num_bytes_saved == 4 * 5 + 2 * 9 + 2 * 7);
+  assert(stats.num_bytes > 4 + 8 + 6 + 3);
+
+  dict_iter_t Di;
+  dict_iter_init(&Di, D);
+  while (dict_iter_next(&Di)) {
+    memory_free(dict_iter_value(&Di));
+  }
+  dict_destroy(D);
+  intern_destroy(T);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_intern_basic();
+  test_intern_dict_keys();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
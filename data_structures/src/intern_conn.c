@@ -0,0 +1,86 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../include/memory.h"
+#include "../include/str.h"
+#include "../include/intern.h"
+#include "../include/intern_conn.h"
+
+struct _impl_intern_conn_t {
+  intern_t *T;
+  pthread_rwlock_t *rwlock;
+  // Hits found under the read lock, which T does not count.
+  atomic_size_t num_hits;
+  atomic_size_t num_bytes_saved;
+};
+
+intern_conn_t *intern_conn_create(intern_t *T) {
+  intern_conn_t *TC = (intern_conn_t *) memory_malloc(sizeof(intern_conn_t));
+
+  TC->T = T;
+  atomic_init(&TC->num_hits, 0);
+  atomic_init(&TC->num_bytes_saved, 0);
+  TC->rwlock = memory_malloc(sizeof(pthread_rwlock_t));
+  int ret = pthread_rwlock_init(TC->rwlock, NULL);
+  if (ret != 0) { // could not make lock
+    return NULL;
+  }
+
+  return TC;
+}
+
+void intern_conn_destroy(intern_conn_t *TC) {
+  assert(TC);
+  intern_destroy(TC->T);
+  pthread_rwlock_destroy(TC->rwlock);
+  memory_free(TC->rwlock);
+  memory_free(TC);
+}
+
+size_t intern_conn_len(intern_conn_t *TC) {
+  assert(TC);
+  pthread_rwlock_rdlock(TC->rwlock);
+  size_t len = intern_len(TC->T);
+  pthread_rwlock_unlock(TC->rwlock);
+  return len;
+}
+
+str_t intern_conn_get(intern_conn_t *TC, str_view_t V) {
+  assert(TC);
+  pthread_rwlock_rdlock(TC->rwlock);
+  str_t s = intern_get(TC->T, V);
+  pthread_rwlock_unlock(TC->rwlock);
+  return s;
+}
+
+void intern_conn_stats(intern_conn_t *TC, intern_stats_t *stats) {
+  assert(TC);
+  pthread_rwlock_rdlock(TC->rwlock);
+  intern_stats(TC->T, stats);
+  pthread_rwlock_unlock(TC->rwlock);
+  stats->num_hits += atomic_load(&TC->num_hits);
+  stats->num_bytes_saved += atomic_load(&TC->num_bytes_saved);
+}
+
+str_t intern_conn_view(intern_conn_t *TC, str_view_t V) {
+  assert(TC);
+
+  str_t s = intern_conn_get(TC, V);
+  if (s != NULL) {
+    atomic_fetch_add_explicit(&TC->num_hits, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&TC->num_bytes_saved, V.len + 1, memory_order_relaxed);
+    return s;
+  }
+
+  // Another thread may intern V in between, which intern_view handles.
+  pthread_rwlock_wrlock(TC->rwlock);
+  s = intern_view(TC->T, V);
+  pthread_rwlock_unlock(TC->rwlock);
+  return s;
+}
+
+str_t intern_conn_str(intern_conn_t *TC, str_t s) {
+  assert(s);
+  return intern_conn_view(TC, str_view(s));
+}
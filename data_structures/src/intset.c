@@ -0,0 +1,813 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../include/list.h"
+#include "../include/memory.h"
+#include "../include/set.h"
+#include "../include/intset.h"
+
+/* Word kernels shared by bitset_t and the bitmap containers of roaring_t.
+ * Each works on n 64-bit words, vectorized when the compiler targets
+ * SSE2/AVX2, with the remaining words done one at a time.
+ */
+#if defined(__AVX2__)
+#define INTSET_VECTOR_WORDS 4
+#define _intset_load(p) _mm256_loadu_si256((const __m256i *) (p))
+#define _intset_store(p, v) _mm256_storeu_si256((__m256i *) (p), v)
+#define _intset_or(a, b) _mm256_or_si256(a, b)
+#define _intset_and(a, b) _mm256_and_si256(a, b)
+#define _intset_andnot(a, b) _mm256_andnot_si256(b, a)
+#elif defined(__SSE2__)
+#define INTSET_VECTOR_WORDS 2
+#define _intset_load(p) _mm_loadu_si128((const __m128i *) (p))
+#define _intset_store(p, v) _mm_storeu_si128((__m128i *) (p), v)
+#define _intset_or(a, b) _mm_or_si128(a, b)
+#define _intset_and(a, b) _mm_and_si128(a, b)
+#define _intset_andnot(a, b) _mm_andnot_si128(b, a)
+#else
+#define INTSET_VECTOR_WORDS 0
+#endif
+
+// dst |= src
+void _words_or(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+#if INTSET_VECTOR_WORDS > 0
+  for (; i + INTSET_VECTOR_WORDS <= n; i += INTSET_VECTOR_WORDS) {
+    _intset_store(dst + i, _intset_or(_intset_load(dst + i), _intset_load(src + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] |= src[i];
+  }
+}
+
+// dst &= src
+void _words_and(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+#if INTSET_VECTOR_WORDS > 0
+  for (; i + INTSET_VECTOR_WORDS <= n; i += INTSET_VECTOR_WORDS) {
+    _intset_store(dst + i, _intset_and(_intset_load(dst + i), _intset_load(src + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] &= src[i];
+  }
+}
+
+// dst &= ~src
+void _words_andnot(uint64_t *dst, const uint64_t *src, size_t n) {
+  size_t i = 0;
+#if INTSET_VECTOR_WORDS > 0
+  for (; i + INTSET_VECTOR_WORDS <= n; i += INTSET_VECTOR_WORDS) {
+    _intset_store(dst + i, _intset_andnot(_intset_load(dst + i), _intset_load(src + i)));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] &= ~src[i];
+  }
+}
+
+#if defined(__AVX2__)
+/* Count the bits of each byte with a 4-bit lookup table,
+ * then sum the bytes of each 64-bit lane.
+ */
+size_t _words_popcount(const uint64_t *w, size_t n) {
+  const __m256i table = _mm256_setr_epi8(
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+  );
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i acc = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _intset_load(w + i);
+    __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low_mask));
+    __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+  }
+
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i *) lanes, acc);
+  size_t count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < n; i++) {
+    count += __builtin_popcountll(w[i]);
+  }
+  return count;
+}
+#else
+size_t _words_popcount(const uint64_t *w, size_t n) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += __builtin_popcountll(w[i]);
+  }
+  return count;
+}
+#endif
+
+// Push v onto L as an int *. v must fit in an int.
+void _intset_push(list_t *L, size_t v) {
+  assert(v <= INT_MAX);
+  int *e = (int *) memory_malloc(sizeof(int));
+  *e = (int) v;
+  list_push(L, e);
+}
+
+// Push each set bit of w, offset by base, onto L as an int *.
+void _words_to_list(const uint64_t *w, size_t n, size_t base, list_t *L) {
+  uint64_t word;
+  for (size_t i = 0; i < n; i++) {
+    word = w[i];
+    while (word != 0) {
+      _intset_push(L, base + 64 * i + __builtin_ctzll(word));
+      word &= word - 1;
+    }
+  }
+}
+
+uint64_t *_words_copy(const uint64_t *w, size_t n) {
+  uint64_t *c = (uint64_t *) memory_malloc(n * sizeof(uint64_t));
+  memcpy(c, w, n * sizeof(uint64_t));
+  return c;
+}
+
+struct _impl_bitset_t {
+  size_t num_words;
+  uint64_t *words;
+};
+
+void _bitset_grow(bitset_t *B, size_t num_words) {
+  if (num_words <= B->num_words) {
+    return;
+  }
+  if (num_words < 2 * B->num_words) {
+    num_words = 2 * B->num_words;
+  }
+
+  uint64_t *words = (uint64_t *) memory_calloc(num_words, sizeof(uint64_t));
+  memcpy(words, B->words, B->num_words * sizeof(uint64_t));
+  memory_free(B->words);
+  B->words = words;
+  B->num_words = num_words;
+}
+
+bitset_t *bitset_create(size_t n) {
+  bitset_t *B = (bitset_t *) memory_malloc(sizeof(bitset_t));
+
+  B->num_words = (n + 63) / 64;
+  if (B->num_words == 0) {
+    B->num_words = 1;
+  }
+  B->words = (uint64_t *) memory_calloc(B->num_words, sizeof(uint64_t));
+
+  return B;
+}
+
+void bitset_destroy(bitset_t *B) {
+  assert(B);
+
+  memory_free(B->words);
+  memory_free(B);
+}
+
+size_t bitset_len(bitset_t *B) {
+  assert(B);
+
+  return _words_popcount(B->words, B->num_words);
+}
+
+bool bitset_includes(bitset_t *B, size_t e) {
+  assert(B);
+
+  if (e / 64 >= B->num_words) {
+    return false;
+  }
+  return (B->words[e / 64] >> (e % 64)) & 1;
+}
+
+void bitset_add(bitset_t *B, size_t e) {
+  assert(B);
+
+  _bitset_grow(B, e / 64 + 1);
+  B->words[e / 64] |= (uint64_t) 1 << (e % 64);
+}
+
+bool bitset_remove(bitset_t *B, size_t e) {
+  assert(B);
+
+  if (!bitset_includes(B, e)) {
+    return false;
+  }
+  B->words[e / 64] &= ~((uint64_t) 1 << (e % 64));
+  return true;
+}
+
+void bitset_union_into(bitset_t *B, bitset_t *C) {
+  assert(B);
+  assert(C);
+
+  _bitset_grow(B, C->num_words);
+  _words_or(B->words, C->words, C->num_words);
+}
+
+void bitset_intersect_inplace(bitset_t *B, bitset_t *C) {
+  assert(B);
+  assert(C);
+
+  if (C->num_words < B->num_words) {
+    _words_and(B->words, C->words, C->num_words);
+    memset(B->words + C->num_words, 0, (B->num_words - C->num_words) * sizeof(uint64_t));
+  } else {
+    _words_and(B->words, C->words, B->num_words);
+  }
+}
+
+void bitset_difference_inplace(bitset_t *B, bitset_t *C) {
+  assert(B);
+  assert(C);
+
+  size_t n = B->num_words < C->num_words ? B->num_words : C->num_words;
+  _words_andnot(B->words, C->words, n);
+}
+
+list_t *bitset_to_list(bitset_t *B) {
+  assert(B);
+
+  list_t *L = list_create(0);
+  _words_to_list(B->words, B->num_words, 0, L);
+  return L;
+}
+
+bitset_t *bitset_from_list(list_t *L) {
+  assert(L);
+
+  // Size the bitset for the largest entry upfront.
+  size_t n = 0;
+  int e;
+  for (int i = 0; i < list_len(L); i++) {
+    e = *((int *) list_get(L, i));
+    assert(e >= 0);
+    if ((size_t) e >= n) {
+      n = e + 1;
+    }
+  }
+
+  bitset_t *B = bitset_create(n);
+  for (int i = 0; i < list_len(L); i++) {
+    bitset_add(B, *((int *) list_get(L, i)));
+  }
+  return B;
+}
+
+bitset_t *bitset_from_set(set_t *S) {
+  assert(S);
+
+  bitset_t *B = bitset_create(0);
+  int e;
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    e = *((int *) set_iter_entry(&It));
+    assert(e >= 0);
+    bitset_add(B, e);
+  }
+  return B;
+}
+
+/* Containers of a roaring_t.
+ *
+ * A container holds the entries that share a key, their high 16 bits.
+ * Up to ROARING_ARRAY_MAX entries are kept as a sorted array of
+ * their low 16 bits, which takes at most as much space as the bitmap
+ * of ROARING_BITMAP_WORDS words used for more entries than that.
+ * Exactly one of arr and bits is not NULL.
+ */
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_BITMAP_WORDS 1024
+
+struct _container {
+  uint16_t key;
+  size_t len;
+  size_t capacity;
+  uint16_t *arr;
+  uint64_t *bits;
+};
+typedef struct _container container;
+
+void _container_init_array(container *c, uint16_t key, size_t capacity) {
+  if (capacity == 0) {
+    capacity = 1;
+  }
+  c->key = key;
+  c->len = 0;
+  c->capacity = capacity;
+  c->arr = (uint16_t *) memory_malloc(capacity * sizeof(uint16_t));
+  c->bits = NULL;
+}
+
+void _container_init_bitmap(container *c, uint16_t key) {
+  c->key = key;
+  c->len = 0;
+  c->capacity = 0;
+  c->arr = NULL;
+  c->bits = (uint64_t *) memory_calloc(ROARING_BITMAP_WORDS, sizeof(uint64_t));
+}
+
+void _container_free(container *c) {
+  if (c->arr != NULL) {
+    memory_free(c->arr);
+  }
+  if (c->bits != NULL) {
+    memory_free(c->bits);
+  }
+}
+
+void _container_copy(container *dst, container *src) {
+  *dst = *src;
+  if (src->arr != NULL) {
+    dst->capacity = src->len > 0 ? src->len : 1;
+    dst->arr = (uint16_t *) memory_malloc(dst->capacity * sizeof(uint16_t));
+    memcpy(dst->arr, src->arr, src->len * sizeof(uint16_t));
+  } else {
+    dst->bits = _words_copy(src->bits, ROARING_BITMAP_WORDS);
+  }
+}
+
+bool _bits_includes(uint64_t *bits, uint16_t low) {
+  return (bits[low / 64] >> (low % 64)) & 1;
+}
+
+void _bits_add(uint64_t *bits, uint16_t low) {
+  bits[low / 64] |= (uint64_t) 1 << (low % 64);
+}
+
+void _bits_remove(uint64_t *bits, uint16_t low) {
+  bits[low / 64] &= ~((uint64_t) 1 << (low % 64));
+}
+
+// If low is in the array, set *i to its position and return true.
+// Else, set *i to where it would be inserted.
+bool _array_find(uint16_t *arr, size_t len, uint16_t low, size_t *i) {
+  size_t lo = 0;
+  size_t hi = len;
+  size_t mid;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (arr[mid] < low) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *i = lo;
+  return lo < len && arr[lo] == low;
+}
+
+void _container_to_bitmap(container *c) {
+  uint64_t *bits = (uint64_t *) memory_calloc(ROARING_BITMAP_WORDS, sizeof(uint64_t));
+  for (size_t i = 0; i < c->len; i++) {
+    _bits_add(bits, c->arr[i]);
+  }
+  memory_free(c->arr);
+  c->arr = NULL;
+  c->capacity = 0;
+  c->bits = bits;
+}
+
+void _container_to_array(container *c) {
+  uint16_t *arr = (uint16_t *) memory_malloc((c->len > 0 ? c->len : 1) * sizeof(uint16_t));
+  size_t n = 0;
+  uint64_t word;
+  for (size_t i = 0; i < ROARING_BITMAP_WORDS; i++) {
+    word = c->bits[i];
+    while (word != 0) {
+      arr[n] = (uint16_t) (64 * i + __builtin_ctzll(word));
+      n++;
+      word &= word - 1;
+    }
+  }
+  assert(n == c->len);
+  memory_free(c->bits);
+  c->bits = NULL;
+  c->arr = arr;
+  c->capacity = c->len > 0 ? c->len : 1;
+}
+
+// Pick the smaller representation for the container's length.
+void _container_normalize(container *c) {
+  if (c->bits != NULL && c->len <= ROARING_ARRAY_MAX) {
+    _container_to_array(c);
+  } else if (c->arr != NULL && c->len > ROARING_ARRAY_MAX) {
+    _container_to_bitmap(c);
+  }
+}
+
+bool _container_includes(container *c, uint16_t low) {
+  if (c->bits != NULL) {
+    return _bits_includes(c->bits, low);
+  }
+  size_t i;
+  return _array_find(c->arr, c->len, low, &i);
+}
+
+void _container_add(container *c, uint16_t low) {
+  if (c->bits != NULL) {
+    if (!_bits_includes(c->bits, low)) {
+      _bits_add(c->bits, low);
+      c->len++;
+    }
+    return;
+  }
+
+  size_t i;
+  if (_array_find(c->arr, c->len, low, &i)) {
+    return;
+  }
+  if (c->len == ROARING_ARRAY_MAX) {
+    _container_to_bitmap(c);
+    _bits_add(c->bits, low);
+    c->len++;
+    return;
+  }
+  if (c->len == c->capacity) {
+    uint16_t *arr = (uint16_t *) memory_malloc(2 * c->capacity * sizeof(uint16_t));
+    memcpy(arr, c->arr, c->len * sizeof(uint16_t));
+    memory_free(c->arr);
+    c->arr = arr;
+    c->capacity *= 2;
+  }
+  memmove(c->arr + i + 1, c->arr + i, (c->len - i) * sizeof(uint16_t));
+  c->arr[i] = low;
+  c->len++;
+}
+
+bool _container_remove(container *c, uint16_t low) {
+  if (c->bits != NULL) {
+    if (!_bits_includes(c->bits, low)) {
+      return false;
+    }
+    _bits_remove(c->bits, low);
+    c->len--;
+    _container_normalize(c);
+    return true;
+  }
+
+  size_t i;
+  if (!_array_find(c->arr, c->len, low, &i)) {
+    return false;
+  }
+  memmove(c->arr + i, c->arr + i + 1, (c->len - i - 1) * sizeof(uint16_t));
+  c->len--;
+  return true;
+}
+
+void _container_union(container *a, container *b, container *res) {
+  if (a->bits == NULL && b->bits == NULL && a->len + b->len <= ROARING_ARRAY_MAX) {
+    // Merge the two sorted arrays.
+    _container_init_array(res, a->key, a->len + b->len);
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a->len || j < b->len) {
+      if (j == b->len || (i < a->len && a->arr[i] < b->arr[j])) {
+        res->arr[res->len++] = a->arr[i++];
+      } else if (i == a->len || b->arr[j] < a->arr[i]) {
+        res->arr[res->len++] = b->arr[j++];
+      } else {
+        res->arr[res->len++] = a->arr[i];
+        i++;
+        j++;
+      }
+    }
+    return;
+  }
+
+  _container_copy(res, a);
+  if (res->bits == NULL) {
+    _container_to_bitmap(res);
+  }
+  if (b->bits != NULL) {
+    _words_or(res->bits, b->bits, ROARING_BITMAP_WORDS);
+  } else {
+    for (size_t j = 0; j < b->len; j++) {
+      _bits_add(res->bits, b->arr[j]);
+    }
+  }
+  res->len = _words_popcount(res->bits, ROARING_BITMAP_WORDS);
+  _container_normalize(res);
+}
+
+void _container_intersection(container *a, container *b, container *res) {
+  if (a->bits != NULL && b->bits != NULL) {
+    _container_copy(res, a);
+    _words_and(res->bits, b->bits, ROARING_BITMAP_WORDS);
+    res->len = _words_popcount(res->bits, ROARING_BITMAP_WORDS);
+    _container_normalize(res);
+    return;
+  }
+
+  // At least one side is an array, so walk it.
+  if (a->bits != NULL) {
+    container *t = a;
+    a = b;
+    b = t;
+  }
+  _container_init_array(res, a->key, a->len);
+  if (b->bits != NULL) {
+    for (size_t i = 0; i < a->len; i++) {
+      if (_bits_includes(b->bits, a->arr[i])) {
+        res->arr[res->len++] = a->arr[i];
+      }
+    }
+    return;
+  }
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < a->len && j < b->len) {
+    if (a->arr[i] < b->arr[j]) {
+      i++;
+    } else if (b->arr[j] < a->arr[i]) {
+      j++;
+    } else {
+      res->arr[res->len++] = a->arr[i];
+      i++;
+      j++;
+    }
+  }
+}
+
+void _container_difference(container *a, container *b, container *res) {
+  if (a->bits != NULL) {
+    _container_copy(res, a);
+    if (b->bits != NULL) {
+      _words_andnot(res->bits, b->bits, ROARING_BITMAP_WORDS);
+    } else {
+      for (size_t j = 0; j < b->len; j++) {
+        _bits_remove(res->bits, b->arr[j]);
+      }
+    }
+    res->len = _words_popcount(res->bits, ROARING_BITMAP_WORDS);
+    _container_normalize(res);
+    return;
+  }
+
+  _container_init_array(res, a->key, a->len);
+  if (b->bits != NULL) {
+    for (size_t i = 0; i < a->len; i++) {
+      if (!_bits_includes(b->bits, a->arr[i])) {
+        res->arr[res->len++] = a->arr[i];
+      }
+    }
+    return;
+  }
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < a->len) {
+    if (j == b->len || a->arr[i] < b->arr[j]) {
+      res->arr[res->len++] = a->arr[i];
+      i++;
+    } else if (b->arr[j] < a->arr[i]) {
+      j++;
+    } else {
+      i++;
+      j++;
+    }
+  }
+}
+
+struct _impl_roaring_t {
+  // Containers sorted by key, none of them empty.
+  size_t num_containers;
+  size_t capacity;
+  container *C;
+};
+
+// If there is a container for key, set *i to its position and return true.
+// Else, set *i to where it would be inserted.
+bool _roaring_find(roaring_t *R, uint16_t key, size_t *i) {
+  size_t lo = 0;
+  size_t hi = R->num_containers;
+  size_t mid;
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (R->C[mid].key < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  *i = lo;
+  return lo < R->num_containers && R->C[lo].key == key;
+}
+
+// Make room for one more container at position i.
+container *_roaring_insert(roaring_t *R, size_t i) {
+  if (R->num_containers == R->capacity) {
+    size_t capacity = R->capacity > 0 ? 2 * R->capacity : 1;
+    container *C = (container *) memory_malloc(capacity * sizeof(container));
+    if (R->C != NULL) {
+      memcpy(C, R->C, R->num_containers * sizeof(container));
+      memory_free(R->C);
+    }
+    R->C = C;
+    R->capacity = capacity;
+  }
+  memmove(R->C + i + 1, R->C + i, (R->num_containers - i) * sizeof(container));
+  R->num_containers++;
+  return &R->C[i];
+}
+
+// Append the result of an operation, dropping it if empty.
+void _roaring_append(roaring_t *R, container *c) {
+  if (c->len == 0) {
+    _container_free(c);
+    return;
+  }
+  *_roaring_insert(R, R->num_containers) = *c;
+}
+
+roaring_t *roaring_create() {
+  roaring_t *R = (roaring_t *) memory_malloc(sizeof(roaring_t));
+
+  R->num_containers = 0;
+  R->capacity = 0;
+  R->C = NULL;
+
+  return R;
+}
+
+void roaring_destroy(roaring_t *R) {
+  assert(R);
+
+  for (size_t i = 0; i < R->num_containers; i++) {
+    _container_free(&R->C[i]);
+  }
+  if (R->C != NULL) {
+    memory_free(R->C);
+  }
+  memory_free(R);
+}
+
+size_t roaring_len(roaring_t *R) {
+  assert(R);
+
+  size_t len = 0;
+  for (size_t i = 0; i < R->num_containers; i++) {
+    len += R->C[i].len;
+  }
+  return len;
+}
+
+bool roaring_includes(roaring_t *R, uint32_t e) {
+  assert(R);
+
+  size_t i;
+  if (!_roaring_find(R, e >> 16, &i)) {
+    return false;
+  }
+  return _container_includes(&R->C[i], e & 0xffff);
+}
+
+void roaring_add(roaring_t *R, uint32_t e) {
+  assert(R);
+
+  size_t i;
+  if (!_roaring_find(R, e >> 16, &i)) {
+    _container_init_array(_roaring_insert(R, i), e >> 16, 0);
+  }
+  _container_add(&R->C[i], e & 0xffff);
+}
+
+bool roaring_remove(roaring_t *R, uint32_t e) {
+  assert(R);
+
+  size_t i;
+  if (!_roaring_find(R, e >> 16, &i)) {
+    return false;
+  }
+  if (!_container_remove(&R->C[i], e & 0xffff)) {
+    return false;
+  }
+  if (R->C[i].len == 0) {
+    _container_free(&R->C[i]);
+    memmove(R->C + i, R->C + i + 1, (R->num_containers - i - 1) * sizeof(container));
+    R->num_containers--;
+  }
+  return true;
+}
+
+roaring_t *roaring_union(roaring_t *R1, roaring_t *R2) {
+  assert(R1);
+  assert(R2);
+
+  roaring_t *R = roaring_create();
+  container c;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < R1->num_containers || j < R2->num_containers) {
+    if (j == R2->num_containers || (i < R1->num_containers && R1->C[i].key < R2->C[j].key)) {
+      _container_copy(&c, &R1->C[i++]);
+    } else if (i == R1->num_containers || R2->C[j].key < R1->C[i].key) {
+      _container_copy(&c, &R2->C[j++]);
+    } else {
+      _container_union(&R1->C[i++], &R2->C[j++], &c);
+    }
+    _roaring_append(R, &c);
+  }
+  return R;
+}
+
+roaring_t *roaring_intersection(roaring_t *R1, roaring_t *R2) {
+  assert(R1);
+  assert(R2);
+
+  roaring_t *R = roaring_create();
+  container c;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < R1->num_containers && j < R2->num_containers) {
+    if (R1->C[i].key < R2->C[j].key) {
+      i++;
+    } else if (R2->C[j].key < R1->C[i].key) {
+      j++;
+    } else {
+      _container_intersection(&R1->C[i++], &R2->C[j++], &c);
+      _roaring_append(R, &c);
+    }
+  }
+  return R;
+}
+
+roaring_t *roaring_difference(roaring_t *R1, roaring_t *R2) {
+  assert(R1);
+  assert(R2);
+
+  roaring_t *R = roaring_create();
+  container c;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < R1->num_containers) {
+    if (j == R2->num_containers || R1->C[i].key < R2->C[j].key) {
+      _container_copy(&c, &R1->C[i++]);
+    } else if (R2->C[j].key < R1->C[i].key) {
+      j++;
+      continue;
+    } else {
+      _container_difference(&R1->C[i++], &R2->C[j++], &c);
+    }
+    _roaring_append(R, &c);
+  }
+  return R;
+}
+
+list_t *roaring_to_list(roaring_t *R) {
+  assert(R);
+
+  list_t *L = list_create(0);
+  container *c;
+  for (size_t i = 0; i < R->num_containers; i++) {
+    c = &R->C[i];
+    if (c->bits != NULL) {
+      _words_to_list(c->bits, ROARING_BITMAP_WORDS, (size_t) c->key << 16, L);
+      continue;
+    }
+    for (size_t j = 0; j < c->len; j++) {
+      _intset_push(L, ((uint32_t) c->key << 16) | c->arr[j]);
+    }
+  }
+  return L;
+}
+
+roaring_t *roaring_from_list(list_t *L) {
+  assert(L);
+
+  roaring_t *R = roaring_create();
+  int e;
+  for (int i = 0; i < list_len(L); i++) {
+    e = *((int *) list_get(L, i));
+    assert(e >= 0);
+    roaring_add(R, e);
+  }
+  return R;
+}
+
+roaring_t *roaring_from_set(set_t *S) {
+  assert(S);
+
+  roaring_t *R = roaring_create();
+  int e;
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    e = *((int *) set_iter_entry(&It));
+    assert(e >= 0);
+    roaring_add(R, e);
+  }
+  return R;
+}
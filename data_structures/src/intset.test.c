@@ -0,0 +1,205 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/list_extended.h"
+#include "../include/memory.h"
+#include "../include/set.h"
+#include "../include/set_extended.h"
+#include "../include/intset.h"
+
+// Deterministic pseudo-random entries, spread over several containers.
+list_t *_entries(size_t n, unsigned int seed, int range) {
+  list_t *L = list_create(n);
+  unsigned int x = seed;
+  for (int i = 0; i < n; i++) {
+    x = x * 1103515245 + 12345;
+    list_set(L, i, int_wrap((x >> 1) % range));
+  }
+  return L;
+}
+
+// Whether L holds exactly the entries of S, in increasing order.
+bool _list_matches_set(list_t *L, set_t *S) {
+  if (list_len(L) != set_len(S)) {
+    return false;
+  }
+  for (int i = 0; i < list_len(L); i++) {
+    if (!set_includes(S, list_get(L, i))) {
+      return false;
+    }
+    if (i > 0 && int_unwrap(list_get(L, i - 1)) >= int_unwrap(list_get(L, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void test_basic_bitset() {
+  printf("basic bitset\n");
+
+  bitset_t *B = bitset_create(0);
+  assert(bitset_len(B) == 0);
+  assert(bitset_includes(B, 0) == false);
+  assert(bitset_includes(B, 1000) == false);
+
+  bitset_add(B, 3);
+  bitset_add(B, 1000);
+  bitset_add(B, 3);
+  assert(bitset_len(B) == 2);
+  assert(bitset_includes(B, 3) == true);
+  assert(bitset_includes(B, 1000) == true);
+  assert(bitset_includes(B, 4) == false);
+
+  assert(bitset_remove(B, 3) == true);
+  assert(bitset_remove(B, 3) == false);
+  assert(bitset_remove(B, 100000) == false);
+  assert(bitset_len(B) == 1);
+
+  list_t *L = bitset_to_list(B);
+  assert(list_len(L) == 1);
+  assert(int_unwrap(list_get(L, 0)) == 1000);
+  list_total_destroy(L, memory_free);
+
+  bitset_destroy(B);
+}
+
+void test_basic_roaring() {
+  printf("basic roaring\n");
+
+  roaring_t *R = roaring_create();
+  assert(roaring_len(R) == 0);
+  assert(roaring_includes(R, 0) == false);
+
+  roaring_add(R, 70000);
+  roaring_add(R, 5);
+  roaring_add(R, 5);
+  roaring_add(R, 4000000000u);
+  assert(roaring_len(R) == 3);
+  assert(roaring_includes(R, 5) == true);
+  assert(roaring_includes(R, 70000) == true);
+  assert(roaring_includes(R, 4000000000u) == true);
+  assert(roaring_includes(R, 6) == false);
+  assert(roaring_includes(R, 70001) == false);
+
+  assert(roaring_remove(R, 4000000000u) == true);
+  assert(roaring_remove(R, 4000000000u) == false);
+  assert(roaring_len(R) == 2);
+
+  list_t *L = roaring_to_list(R);
+  assert(list_len(L) == 2);
+  assert(int_unwrap(list_get(L, 0)) == 5);
+  assert(int_unwrap(list_get(L, 1)) == 70000);
+  list_total_destroy(L, memory_free);
+
+  // A dense container switches to a bitmap and back.
+  for (int i = 0; i < 10000; i++) {
+    roaring_add(R, i);
+  }
+  assert(roaring_len(R) == 10001);
+  for (int i = 0; i < 9000; i++) {
+    assert(roaring_remove(R, i) == true);
+  }
+  assert(roaring_len(R) == 1001);
+  assert(roaring_includes(R, 9000) == true);
+  assert(roaring_includes(R, 8999) == false);
+
+  roaring_destroy(R);
+}
+
+void test_intset_algebra() {
+  printf("intset algebra\n");
+
+  // Dense in one container, sparse in the others,
+  // so every pair of container kinds is exercised.
+  list_t *L1 = _entries(20000, 1, 200000);
+  list_t *L2 = _entries(20000, 2, 200000);
+  for (int i = 0; i < 10000; i++) {
+    list_push(L1, int_wrap(i));
+    list_push(L2, int_wrap(2 * i));
+  }
+
+  set_t *S1 = set_from_list(L1, int_eq, int_hash);
+  set_t *S2 = set_from_list(L2, int_eq, int_hash);
+  set_t *U = set_union(S1, S2, int_eq, int_hash);
+  set_t *I = set_intersection(S1, S2, int_eq, int_hash);
+  set_t *D = set_difference(S1, S2, int_eq, int_hash);
+
+  list_t *L;
+
+  roaring_t *R1 = roaring_from_list(L1);
+  roaring_t *R2 = roaring_from_set(S2);
+  assert(roaring_len(R1) == set_len(S1));
+  assert(roaring_len(R2) == set_len(S2));
+
+  roaring_t *R = roaring_union(R1, R2);
+  L = roaring_to_list(R);
+  assert(_list_matches_set(L, U));
+  list_total_destroy(L, memory_free);
+  roaring_destroy(R);
+
+  R = roaring_intersection(R1, R2);
+  L = roaring_to_list(R);
+  assert(_list_matches_set(L, I));
+  list_total_destroy(L, memory_free);
+  roaring_destroy(R);
+
+  R = roaring_difference(R1, R2);
+  L = roaring_to_list(R);
+  assert(_list_matches_set(L, D));
+  list_total_destroy(L, memory_free);
+  roaring_destroy(R);
+
+  roaring_destroy(R1);
+  roaring_destroy(R2);
+
+  bitset_t *B1 = bitset_from_list(L1);
+  bitset_t *B2 = bitset_from_set(S2);
+  bitset_t *B;
+  assert(bitset_len(B1) == set_len(S1));
+
+  B = bitset_from_set(S1);
+  bitset_union_into(B, B2);
+  L = bitset_to_list(B);
+  assert(_list_matches_set(L, U));
+  list_total_destroy(L, memory_free);
+  bitset_destroy(B);
+
+  B = bitset_from_set(S1);
+  bitset_intersect_inplace(B, B2);
+  L = bitset_to_list(B);
+  assert(_list_matches_set(L, I));
+  list_total_destroy(L, memory_free);
+  bitset_destroy(B);
+
+  bitset_difference_inplace(B1, B2);
+  L = bitset_to_list(B1);
+  assert(_list_matches_set(L, D));
+  list_total_destroy(L, memory_free);
+
+  bitset_destroy(B1);
+  bitset_destroy(B2);
+
+  set_destroy(U);
+  set_destroy(I);
+  set_destroy(D);
+  set_destroy(S1);
+  set_destroy(S2);
+  list_total_destroy(L1, memory_free);
+  list_total_destroy(L2, memory_free);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_basic_bitset();
+  test_basic_roaring();
+  test_intset_algebra();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
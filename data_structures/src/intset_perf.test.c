@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/set.h"
+#include "../include/set_extended.h"
+#include "../include/intset.h"
+
+// Build and intersect two sets of N ids, half of which overlap,
+// as a set_t of int_wrap'd entries.
+void test_set_intersection_performance() {
+  int MAG = 4;
+  set_t *S1;
+  set_t *S2;
+  size_t num_bytes_used;
+  clock_t start;
+  clock_t end;
+  double duration;
+
+  size_t N = 1000000;
+
+  for (int i = 0; i < MAG; i++) {
+    memory_count_reset();
+    S1 = set_create(int_eq, int_hash);
+    S2 = set_create(int_eq, int_hash);
+    for (int i = 0; i < N; i++) {
+      set_add(S1, int_wrap(i));
+      set_add(S2, int_wrap(i + N / 2));
+    }
+    num_bytes_used = memory_count_report();
+
+    start = clock();
+    set_t *I = set_intersection(S1, S2, int_eq, int_hash);
+    end = clock();
+
+    duration = ((double) (end - start)) / CLOCKS_PER_SEC;
+    printf("# ITEMS (SET): %lu\n", N);
+    printf("SECS: %lf\n", duration);
+    printf("# BYTES: %lu\n", num_bytes_used);
+
+    set_destroy(I);
+    set_total_destroy(S1, memory_free);
+    set_total_destroy(S2, memory_free);
+
+    N *= 2;
+  }
+}
+
+void test_roaring_intersection_performance() {
+  int MAG = 4;
+  roaring_t *R1;
+  roaring_t *R2;
+  size_t num_bytes_used;
+  clock_t start;
+  clock_t end;
+  double duration;
+
+  size_t N = 1000000;
+
+  for (int i = 0; i < MAG; i++) {
+    memory_count_reset();
+    R1 = roaring_create();
+    R2 = roaring_create();
+    for (int i = 0; i < N; i++) {
+      roaring_add(R1, i);
+      roaring_add(R2, i + N / 2);
+    }
+    num_bytes_used = memory_count_report();
+
+    start = clock();
+    roaring_t *I = roaring_intersection(R1, R2);
+    end = clock();
+
+    duration = ((double) (end - start)) / CLOCKS_PER_SEC;
+    printf("# ITEMS (ROARING): %lu\n", N);
+    printf("SECS: %lf\n", duration);
+    printf("# BYTES: %lu\n", num_bytes_used);
+
+    roaring_destroy(I);
+    roaring_destroy(R1);
+    roaring_destroy(R2);
+
+    N *= 2;
+  }
+}
+
+void test_bitset_intersection_performance() {
+  int MAG = 4;
+  bitset_t *B1;
+  bitset_t *B2;
+  size_t num_bytes_used;
+  clock_t start;
+  clock_t end;
+  double duration;
+
+  size_t N = 1000000;
+
+  for (int i = 0; i < MAG; i++) {
+    memory_count_reset();
+    B1 = bitset_create(N);
+    B2 = bitset_create(N + N / 2);
+    for (int i = 0; i < N; i++) {
+      bitset_add(B1, i);
+      bitset_add(B2, i + N / 2);
+    }
+    num_bytes_used = memory_count_report();
+
+    start = clock();
+    bitset_intersect_inplace(B1, B2);
+    size_t len = bitset_len(B1);
+    end = clock();
+
+    duration = ((double) (end - start)) / CLOCKS_PER_SEC;
+    printf("# ITEMS (BITSET): %lu\n", N);
+    printf("SECS: %lf\n", duration);
+    printf("# BYTES: %lu\n", num_bytes_used);
+    printf("# LEN: %lu\n", len);
+
+    bitset_destroy(B1);
+    bitset_destroy(B2);
+
+    N *= 2;
+  }
+}
+
+int main() {
+  test_set_intersection_performance();
+  test_roaring_intersection_performance();
+  test_bitset_intersection_performance();
+
+  return 0;
+}
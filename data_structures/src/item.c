@@ -54,3 +54,9 @@ void item_set_value(item_t *I, addr_t v) {
 
   I->value = v;
 }
+
+addr_t *item_value_slot(item_t *I) {
+  assert(I);
+
+  return &I->value;
+}
@@ -0,0 +1,231 @@
+#include <assert.h>
+
+#include "../include/list.h"
+#include "../include/dict.h"
+#include "../include/set.h"
+#include "../include/iter.h"
+
+void _iter_init(iter_t *It, bool (*next)(iter_t *It, addr_t *e)) {
+  assert(It);
+
+  It->next = next;
+  It->src = NULL;
+  It->other = NULL;
+  It->L = NULL;
+  It->index = 0;
+  It->remaining = 0;
+  It->map = NULL;
+  It->filter = NULL;
+  It->zip = NULL;
+}
+
+bool _iter_list_next(iter_t *It, addr_t *e) {
+  if (It->index >= list_len(It->L)) {
+    return false;
+  }
+  *e = list_get(It->L, It->index);
+  It->index++;
+  return true;
+}
+
+void iter_from_list(iter_t *It, list_t *L) {
+  assert(L);
+
+  _iter_init(It, _iter_list_next);
+  It->L = L;
+}
+
+bool _iter_dict_items_next(iter_t *It, addr_t *e) {
+  if (!dict_iter_next(&It->DI)) {
+    return false;
+  }
+  *e = dict_iter_item(&It->DI);
+  return true;
+}
+
+void iter_from_dict_items(iter_t *It, dict_t *D) {
+  assert(D);
+
+  _iter_init(It, _iter_dict_items_next);
+  dict_iter_init(&It->DI, D);
+}
+
+bool _iter_dict_keys_next(iter_t *It, addr_t *e) {
+  if (!dict_iter_next(&It->DI)) {
+    return false;
+  }
+  *e = dict_iter_key(&It->DI);
+  return true;
+}
+
+void iter_from_dict_keys(iter_t *It, dict_t *D) {
+  assert(D);
+
+  _iter_init(It, _iter_dict_keys_next);
+  dict_iter_init(&It->DI, D);
+}
+
+bool _iter_dict_values_next(iter_t *It, addr_t *e) {
+  if (!dict_iter_next(&It->DI)) {
+    return false;
+  }
+  *e = dict_iter_value(&It->DI);
+  return true;
+}
+
+void iter_from_dict_values(iter_t *It, dict_t *D) {
+  assert(D);
+
+  _iter_init(It, _iter_dict_values_next);
+  dict_iter_init(&It->DI, D);
+}
+
+bool _iter_set_next(iter_t *It, addr_t *e) {
+  if (!set_iter_next(&It->SI)) {
+    return false;
+  }
+  *e = set_iter_entry(&It->SI);
+  return true;
+}
+
+void iter_from_set(iter_t *It, set_t *S) {
+  assert(S);
+
+  _iter_init(It, _iter_set_next);
+  set_iter_init(&It->SI, S);
+}
+
+bool _iter_map_next(iter_t *It, addr_t *e) {
+  addr_t s;
+  if (!iter_next(It->src, &s)) {
+    return false;
+  }
+  *e = It->map(s);
+  return true;
+}
+
+void iter_map(iter_t *It, iter_t *src, addr_t (*map)(addr_t e)) {
+  assert(src);
+
+  _iter_init(It, _iter_map_next);
+  It->src = src;
+  It->map = map;
+}
+
+bool _iter_filter_next(iter_t *It, addr_t *e) {
+  addr_t s;
+  while (iter_next(It->src, &s)) {
+    if (It->filter(s)) {
+      *e = s;
+      return true;
+    }
+  }
+  return false;
+}
+
+void iter_filter(iter_t *It, iter_t *src, bool (*filter)(addr_t e)) {
+  assert(src);
+
+  _iter_init(It, _iter_filter_next);
+  It->src = src;
+  It->filter = filter;
+}
+
+bool _iter_take_next(iter_t *It, addr_t *e) {
+  // Check the budget first so that the source is never pulled past n.
+  if (It->remaining == 0) {
+    return false;
+  }
+  if (!iter_next(It->src, e)) {
+    It->remaining = 0;
+    return false;
+  }
+  It->remaining--;
+  return true;
+}
+
+void iter_take(iter_t *It, iter_t *src, size_t n) {
+  assert(src);
+
+  _iter_init(It, _iter_take_next);
+  It->src = src;
+  It->remaining = n;
+}
+
+bool _iter_zip_next(iter_t *It, addr_t *e) {
+  addr_t s1;
+  addr_t s2;
+  if (!iter_next(It->src, &s1)) {
+    return false;
+  }
+  if (!iter_next(It->other, &s2)) {
+    return false;
+  }
+  *e = It->zip(s1, s2);
+  return true;
+}
+
+void iter_zip(iter_t *It, iter_t *src1, iter_t *src2, addr_t (*zip)(addr_t e1, addr_t e2)) {
+  assert(src1);
+  assert(src2);
+
+  _iter_init(It, _iter_zip_next);
+  It->src = src1;
+  It->other = src2;
+  It->zip = zip;
+}
+
+bool _iter_chain_next(iter_t *It, addr_t *e) {
+  if (It->src != NULL) {
+    if (iter_next(It->src, e)) {
+      return true;
+    }
+    It->src = NULL;
+  }
+  return iter_next(It->other, e);
+}
+
+void iter_chain(iter_t *It, iter_t *src1, iter_t *src2) {
+  assert(src1);
+  assert(src2);
+
+  _iter_init(It, _iter_chain_next);
+  It->src = src1;
+  It->other = src2;
+}
+
+bool iter_next(iter_t *It, addr_t *e) {
+  assert(It);
+  assert(e);
+
+  return It->next(It, e);
+}
+
+list_t *iter_collect(iter_t *It) {
+  assert(It);
+
+  list_t *L = list_create(0);
+  addr_t e;
+  while (iter_next(It, &e)) {
+    list_push(L, e);
+  }
+  return L;
+}
+
+void iter_for_each(iter_t *It, void (*action)(addr_t e)) {
+  assert(It);
+
+  addr_t e;
+  while (iter_next(It, &e)) {
+    action(e);
+  }
+}
+
+void iter_reduce(iter_t *It, void (*combine)(addr_t acc, addr_t e), addr_t acc) {
+  assert(It);
+
+  addr_t e;
+  while (iter_next(It, &e)) {
+    combine(acc, e);
+  }
+}
@@ -0,0 +1,237 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/item.h"
+#include "../include/memory.h"
+#include "../include/list.h"
+#include "../include/list_extended.h"
+#include "../include/dict.h"
+#include "../include/dict_extended.h"
+#include "../include/set.h"
+#include "../include/set_extended.h"
+#include "../include/iter.h"
+
+list_t *setup(size_t len, int arr[]) {
+  list_t *L = list_create(len);
+  addr_t e;
+  for (int i = 0; i < len; i++) {
+    e = int_wrap(arr[i]);
+    list_set(L, i, e);
+  }
+  return L;
+}
+
+void test_iter_list() {
+  printf("iter list\n");
+
+  list_t *L;
+  list_t *C;
+  iter_t It;
+  addr_t e;
+  str_t actual;
+  str_t expected;
+
+  int arr[] = {4, 9, 5, 5, 8, 7, 1, 6, 2, 3};
+  L = setup(10, arr);
+
+  iter_from_list(&It, L);
+  C = iter_collect(&It);
+  expected = "[4,9,5,5,8,7,1,6,2,3]";
+  actual = list_string(C, int_str);
+  assert(strcmp(actual, expected) == 0);
+  memory_free(actual);
+  list_destroy(C);
+
+  // Exhausted iterators stay exhausted.
+  assert(iter_next(&It, &e) == false);
+
+  list_total_destroy(L, memory_free);
+}
+
+void test_iter_pipeline() {
+  printf("iter pipeline\n");
+
+  list_t *L;
+  list_t *C;
+  iter_t source;
+  iter_t evens;
+  iter_t doubled;
+  iter_t first;
+  str_t actual;
+  str_t expected;
+
+  int arr[] = {4, 9, 5, 5, 8, 7, 1, 6, 2, 3};
+  L = setup(10, arr);
+
+  iter_from_list(&source, L);
+  iter_filter(&evens, &source, int_is_even);
+  iter_map(&doubled, &evens, int_double);
+  iter_take(&first, &doubled, 3);
+  C = iter_collect(&first);
+  expected = "[8,16,12]";
+  actual = list_string(C, int_str);
+  assert(strcmp(actual, expected) == 0);
+  memory_free(actual);
+  list_total_destroy(C, memory_free);
+
+  // take stops pulling as soon as it has n entries,
+  // so the source can be resumed from right after the 6.
+  C = iter_collect(&source);
+  expected = "[2,3]";
+  actual = list_string(C, int_str);
+  assert(strcmp(actual, expected) == 0);
+  memory_free(actual);
+  list_destroy(C);
+
+  list_total_destroy(L, memory_free);
+}
+
+void test_iter_reduce() {
+  printf("iter reduce\n");
+
+  list_t *L;
+  iter_t source;
+  iter_t evens;
+  addr_t acc;
+  size_t num_bytes_used;
+
+  int arr[] = {4, 9, 5, 5, 8, 7, 1, 6, 2, 3};
+  L = setup(10, arr);
+  acc = int_wrap(0);
+
+  memory_count_reset();
+  iter_from_list(&source, L);
+  iter_filter(&evens, &source, int_is_even);
+  iter_reduce(&evens, int_sum, acc);
+  num_bytes_used = memory_count_report();
+
+  assert(int_unwrap(acc) == 20);
+  assert(num_bytes_used == 0);
+
+  memory_free(acc);
+  list_total_destroy(L, memory_free);
+}
+
+void test_iter_zip_chain() {
+  printf("iter zip and chain\n");
+
+  list_t *L1;
+  list_t *L2;
+  list_t *C;
+  iter_t source1;
+  iter_t source2;
+  iter_t zipped;
+  iter_t chained;
+  str_t actual;
+  str_t expected;
+
+  int arr1[] = {0, 1, 2, 3, 4};
+  L1 = setup(5, arr1);
+  int arr2[] = {5, 6, 7};
+  L2 = setup(3, arr2);
+
+  iter_from_list(&source1, L1);
+  iter_from_list(&source2, L2);
+  iter_zip(&zipped, &source1, &source2, int_add);
+  C = iter_collect(&zipped);
+  expected = "[5,7,9]";
+  actual = list_string(C, int_str);
+  assert(strcmp(actual, expected) == 0);
+  memory_free(actual);
+  list_total_destroy(C, memory_free);
+
+  iter_from_list(&source1, L1);
+  iter_from_list(&source2, L2);
+  iter_chain(&chained, &source1, &source2);
+  C = iter_collect(&chained);
+  expected = "[0,1,2,3,4,5,6,7]";
+  actual = list_string(C, int_str);
+  assert(strcmp(actual, expected) == 0);
+  memory_free(actual);
+  list_destroy(C);
+
+  list_total_destroy(L1, memory_free);
+  list_total_destroy(L2, memory_free);
+}
+
+addr_t _item_value(addr_t I) {
+  return item_get_value((item_t *) I);
+}
+
+void test_iter_dict_set() {
+  printf("iter dict and set\n");
+
+  dict_t *D;
+  set_t *S;
+  list_t *L;
+  iter_t source;
+  iter_t values;
+  iter_t evens;
+  addr_t acc;
+
+  D = dict_create(int_eq, int_hash);
+  for (int i = 0; i < 10; i++) {
+    dict_set(D, int_wrap(i), int_wrap(i));
+  }
+
+  L = dict_items(D);
+  acc = int_wrap(0);
+  iter_from_list(&source, L);
+  iter_map(&values, &source, _item_value);
+  iter_filter(&evens, &values, int_is_even);
+  iter_reduce(&evens, int_sum, acc);
+  assert(int_unwrap(acc) == 20);
+  memory_free(acc);
+  list_destroy(L);
+
+  S = set_create(int_eq, int_hash);
+  for (int i = 0; i < 10; i++) {
+    set_add(S, int_wrap(i));
+  }
+
+  L = set_to_list(S);
+  acc = int_wrap(0);
+  iter_from_list(&source, L);
+  iter_filter(&evens, &source, int_is_even);
+  iter_reduce(&evens, int_sum, acc);
+  assert(int_unwrap(acc) == 20);
+  memory_free(acc);
+  list_destroy(L);
+
+  memory_count_reset();
+  acc = int_wrap(0);
+  iter_from_dict_values(&values, D);
+  iter_filter(&evens, &values, int_is_even);
+  iter_reduce(&evens, int_sum, acc);
+  assert(int_unwrap(acc) == 20);
+  memory_free(acc);
+
+  acc = int_wrap(0);
+  iter_from_set(&source, S);
+  iter_filter(&evens, &source, int_is_even);
+  iter_reduce(&evens, int_sum, acc);
+  assert(int_unwrap(acc) == 20);
+  memory_free(acc);
+  assert(memory_count_report() == 2 * sizeof(int));
+
+  dict_total_destroy(D, memory_free, memory_free);
+  set_total_destroy(S, memory_free);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_iter_list();
+  test_iter_pipeline();
+  test_iter_reduce();
+  test_iter_zip_chain();
+  test_iter_dict_set();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include <assert.h>
 
 #include "../include/memory.h"
+#include "../include/str.h"
 #include "../include/linked_list.h"
 
 link_t *link_create(addr_t e) {
@@ -55,42 +56,20 @@ size_t linked_list_len(linked_list_t *LL) {
 str_t linked_list_string(linked_list_t *LL, str_t (*entry_string)(addr_t e)) {
   assert(LL);
 
-  link_t *curr;
-  addr_t e;
-  str_t e_str;
-  size_t len;
-
-  size_t total_size = 0;
-  if (!linked_list_empty(LL)) {
-    curr = LL->join;
-    do {
-      e = curr->value;
-      e_str = entry_string(e);
-      len = strlen(e_str);
-      memory_free(e_str);
-      total_size += len + 2; // +2 for arrow
-      curr = curr->next;
-    } while (curr != LL->join);
-  }
-
-  str_t res = (str_t) memory_calloc(total_size + 2 + 1, sizeof(char)); // +2 for first arrow, +1 for \0
-
-  strncat(res, "->", 2);
+  str_buf_t *B = str_buf_create(0);
+  str_buf_append_n(B, "->", 2);
 
+  link_t *curr;
   if (!linked_list_empty(LL)) {
     curr = LL->join;
     do {
-      e = curr->value;
-      e_str = entry_string(e);
-      len = strlen(e_str);
-      strncat(res, e_str, len);
-      memory_free(e_str);
-      strncat(res, "->", 2);
+      str_buf_append_owned(B, entry_string(curr->value));
+      str_buf_append_n(B, "->", 2);
       curr = curr->next;
     } while (curr != LL->join);
   }
 
-  return res;
+  return str_buf_finish(B);
 }
 
 link_t *linked_list_push(linked_list_t *LL, addr_t e) {
@@ -3,68 +3,74 @@
 #include "../include/memory.h"
 #include "../include/list.h"
 
+/* Lists with at most LIST_INLINE_CAPACITY entries keep them
+ * inside the list_t itself, so small lists (e.g. dict buckets)
+ * cost a single allocation. Larger lists spill to the heap.
+ */
+#define LIST_INLINE_CAPACITY 4
+
 struct _impl_list_t {
   size_t len;
-  // If len == 0, capacity == 0.
-  // Else, capacity / 2 < len <= capacity.
+  // If len <= LIST_INLINE_CAPACITY, arr == inline_arr
+  // and capacity == LIST_INLINE_CAPACITY.
+  // Else, arr is on the heap and capacity / 2 < len <= capacity.
   size_t capacity;
   addr_t *arr;
+  addr_t inline_arr[LIST_INLINE_CAPACITY];
 };
 
-void _list_resize(list_t *L, size_t new_len) {
-  if (new_len == 0) {
-    L->len = 0;
-    L->capacity = 0;
-    addr_t *arr = L->arr;
-    if (arr != NULL) {
-      memory_free(arr);
-    }
-    L->arr = NULL;
-  } else {
-    if (L->capacity / 2 < new_len && new_len <= L->capacity) {
-      L->len = new_len;
-      return;
-    }
-
-    size_t new_capacity;
-    if (L->capacity == 0) {
-      new_capacity = 1;
-    } else {
-      new_capacity = L->capacity;
-    }
-    while (new_capacity < new_len) {
-      new_capacity *= 2;
-    } 
-    while (new_capacity >= 2 * new_len) {
-      new_capacity /= 2;
-    }
+bool _list_is_inline(list_t *L) {
+  return L->arr == L->inline_arr;
+}
 
-    addr_t *arr = (addr_t *) memory_calloc(new_capacity, sizeof(addr_t));
-
-    if (L->arr != NULL) {
-      addr_t e;
-      size_t copy_len = L->len;
-      if (new_capacity < copy_len) {
-        copy_len = new_capacity;
-      }
-      for (int i = 0; i < copy_len; i++) {
-        e = list_get(L, i);
-        *(arr + i) = e;
-      }  
+void _list_resize(list_t *L, size_t new_len) {
+  if (new_len <= LIST_INLINE_CAPACITY) {
+    if (!_list_is_inline(L)) {
+      memcpy(L->inline_arr, L->arr, new_len * sizeof(addr_t));
       memory_free(L->arr);
+      L->arr = L->inline_arr;
+      L->capacity = LIST_INLINE_CAPACITY;
     }
     L->len = new_len;
-    L->capacity = new_capacity;
-    L->arr = arr;
+    return;
+  }
+
+  if (L->capacity / 2 < new_len && new_len <= L->capacity) {
+    L->len = new_len;
+    return;
+  }
+
+  size_t new_capacity = L->capacity;
+  while (new_capacity < new_len) {
+    new_capacity *= 2;
+  } 
+  while (new_capacity >= 2 * new_len) {
+    new_capacity /= 2;
+  }
+
+  addr_t *arr = (addr_t *) memory_calloc(new_capacity, sizeof(addr_t));
+
+  size_t copy_len = L->len;
+  if (new_capacity < copy_len) {
+    copy_len = new_capacity;
   }
+  memcpy(arr, L->arr, copy_len * sizeof(addr_t));
+  if (!_list_is_inline(L)) {
+    memory_free(L->arr);
+  }
+
+  L->len = new_len;
+  L->capacity = new_capacity;
+  L->arr = arr;
 }
 
 list_t *list_create(size_t len) {
   list_t *L = (list_t *) memory_malloc(sizeof(list_t));
 
   L->len = 0;
-  L->capacity = 0;
-  L->arr = NULL;
+  L->capacity = LIST_INLINE_CAPACITY;
+  L->arr = L->inline_arr;
+  memset(L->inline_arr, 0, sizeof(L->inline_arr));
 
   _list_resize(L, len);
 
@@ -74,7 +80,7 @@ list_t *list_create(size_t len) {
 void list_destroy(list_t *L) {
   assert(L);
 
-  if (L->arr != NULL) {
+  if (!_list_is_inline(L)) {
     memory_free(L->arr);
   }
   memory_free(L);
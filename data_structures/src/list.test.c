@@ -381,6 +381,68 @@ void test_list_unique() {
   list_total_destroy(L, memory_free);
 }
 
+void _assert_list_string(list_t *L, str_t expected) {
+  str_t actual = list_string(L, int_str);
+  assert(strcmp(actual, expected) == 0);
+  memory_free(actual);
+}
+
+void test_list_inline() {
+  printf("list inline\n");
+
+  // Lists keep up to 4 entries inline, so crossing
+  // that size has to move the entries on and off the heap.
+  list_t *L = list_create(0);
+  str_t pushed[] = {
+    "[0]", "[0,1]", "[0,1,2]", "[0,1,2,3]",
+    "[0,1,2,3,4]", "[0,1,2,3,4,5]", "[0,1,2,3,4,5,6]"
+  };
+  for (int i = 0; i < 7; i++) {
+    list_push(L, int_wrap(i));
+    assert(list_len(L) == i + 1);
+    _assert_list_string(L, pushed[i]);
+  }
+
+  memory_free(list_remove(L, 3));
+  _assert_list_string(L, "[0,1,2,4,5,6]");
+  memory_free(list_remove(L, 1));
+  memory_free(list_remove(L, 1));
+  _assert_list_string(L, "[0,4,5,6]");
+  list_insert(L, 2, int_wrap(7));
+  _assert_list_string(L, "[0,4,7,5,6]");
+  memory_free(list_remove(L, 2));
+  _assert_list_string(L, "[0,4,5,6]");
+  list_insert(L, 1, int_wrap(8));
+  list_insert(L, 1, int_wrap(9));
+  _assert_list_string(L, "[0,9,8,4,5,6]");
+
+  str_t popped[] = {
+    "[]", "[0]", "[0,9]", "[0,9,8]", "[0,9,8,4]", "[0,9,8,4,5]"
+  };
+  for (int i = 5; i >= 0; i--) {
+    memory_free(list_pop(L));
+    assert(list_len(L) == i);
+    _assert_list_string(L, popped[i]);
+  }
+
+  // Refill after shrinking back inline.
+  list_push(L, int_wrap(1));
+  _assert_list_string(L, "[1]");
+  list_total_destroy(L, memory_free);
+
+  // Pushing up to the inline capacity allocates nothing beyond the list.
+  memory_count_reset();
+  L = list_create(0);
+  size_t num_bytes_used = memory_count_report();
+  for (int i = 0; i < 4; i++) {
+    list_push(L, NULL);
+  }
+  assert(memory_count_report() == num_bytes_used);
+  list_push(L, NULL);
+  assert(memory_count_report() > num_bytes_used);
+  list_destroy(L);
+}
+
 int main() {
   memory_pointers_init();
 
@@ -395,6 +457,7 @@ int main() {
   test_list_concat();
   test_list_sort();
   test_list_unique();
+  test_list_inline();
 
   str_t usage = memory_pointers_report();
   str_t expected = "->";
@@ -2,6 +2,7 @@
 
 #include "../include/list.h"
 #include "../include/memory.h"
+#include "../include/str.h"
 #include "../include/list_extended.h"
 
 void list_total_destroy(list_t *L, void (*entry_destroy)(addr_t e)) {
@@ -20,36 +21,19 @@ void list_total_destroy(list_t *L, void (*entry_destroy)(addr_t e)) {
 str_t list_string(list_t *L, str_t (*entry_string)(addr_t e)) {
   assert(L);
 
-  addr_t e;
-  str_t e_str;
-  size_t len;
+  str_buf_t *B = str_buf_create(0);
+  str_buf_append_char(B, '[');
 
-  size_t total_size = 0;
   for (int i = 0; i < list_len(L); i++) {
-    e = list_get(L, i);
-    e_str = entry_string(e);
-    len = strlen(e_str);
-    memory_free(e_str);
-    total_size += len + 1; // +1 for comma
-  }
-
-  str_t res = (str_t) memory_calloc(total_size + 2 + 1, sizeof(char)); // +2 for brackets, +1 for \0
-  strncat(res, "[", 1);
-
-  for (int i = 0; i < list_len(L); i++) {
-    e = list_get(L, i);
-    e_str = entry_string(e);
-    len = strlen(e_str);
     if (i != 0) {
-      strncat(res, ",", 1);
+      str_buf_append_char(B, ',');
     }
-    strncat(res, e_str, len);
-    memory_free(e_str);
+    str_buf_append_owned(B, entry_string(list_get(L, i)));
   }
 
-  strncat(res, "]", 1);
+  str_buf_append_char(B, ']');
 
-  return res;
+  return str_buf_finish(B);
 }
 
 list_t *list_copy(list_t *L) {
@@ -4,6 +4,9 @@
 #include "../include/test_utils.h"
 #include "../include/memory.h"
 #include "../include/list.h"
+#include "../include/typed.h"
+
+LIST_DEFINE(int_list, int)
 
 void test_list_performance() {
   int MAG = 4;
@@ -43,8 +46,44 @@ void test_list_performance() {
   }
 }
 
+void test_typed_list_performance() {
+  int MAG = 4;
+  int_list_t *L;
+  size_t num_bytes_used;
+  clock_t start;
+  clock_t end;
+  double duration;
+
+  size_t N = 1000000;
+
+  for (int i = 0; i < MAG; i++) {
+    start = clock();
+    memory_count_reset();
+
+    L = int_list_create(0);
+    for (int i = 0; i < N; i++) {
+      int_list_push(L, i);
+    }
+    for (int i = 0; i < N; i++) {
+      int_list_pop(L);
+    }
+    int_list_destroy(L);
+
+    num_bytes_used = memory_count_report();
+    end = clock();
+
+    duration = ((double) (end - start)) / CLOCKS_PER_SEC;
+    printf("# ITEMS (TYPED): %lu\n", N);
+    printf("SECS: %lf\n", duration);
+    printf("# BYTES: %lu\n", num_bytes_used);
+
+    N *= 2;
+  }
+}
+
 int main() {
   test_list_performance();
+  test_typed_list_performance();
 
   return 0;
 }
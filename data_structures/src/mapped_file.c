@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/memory.h"
+#include "../include/str.h"
+#include "../include/mapped_file.h"
+
+struct _impl_mapped_file_t {
+  // NULL for an empty file, which cannot be mapped.
+  char *data;
+  size_t len;
+};
+
+mapped_file_t *mapped_file_open(str_t path, bool sequential) {
+  assert(path);
+
+  // O_NONBLOCK so that opening a FIFO does not wait for a writer
+  // before it is rejected below. It has no effect on regular files.
+  int fd = open(path, O_RDONLY | O_NONBLOCK);
+  if (fd < 0) {
+    return NULL;
+  }
+  // Directories, pipes and devices have no size to map.
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return NULL;
+  }
+
+  char *data = NULL;
+  size_t len = (size_t) st.st_size;
+  if (len > 0) {
+    data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return NULL;
+    }
+    if (sequential) {
+      madvise(data, len, MADV_SEQUENTIAL);
+    }
+  }
+  // The mapping keeps the file open.
+  close(fd);
+
+  mapped_file_t *F = (mapped_file_t *) memory_malloc(sizeof(mapped_file_t));
+  F->data = data;
+  F->len = len;
+  return F;
+}
+
+void mapped_file_close(mapped_file_t *F) {
+  assert(F);
+
+  if (F->data != NULL) {
+    munmap(F->data, F->len);
+  }
+  memory_free(F);
+}
+
+size_t mapped_file_len(mapped_file_t *F) {
+  assert(F);
+  return F->len;
+}
+
+str_view_t mapped_file_view(mapped_file_t *F) {
+  assert(F);
+
+  if (F->data == NULL) {
+    return str_view_n("", 0);
+  }
+  return str_view_n(F->data, F->len);
+}
+
+void mapped_file_lines_init(str_split_iter_t *It, mapped_file_t *F) {
+  str_splitlines_iter_init(It, mapped_file_view(F));
+}
+
+void mapped_file_records_init(str_split_iter_t *It, mapped_file_t *F, str_view_t delimiter) {
+  str_split_iter_init(It, mapped_file_view(F), delimiter);
+}
@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/list_extended.h"
+#include "../include/str.h"
+#include "../include/mapped_file.h"
+
+// Write contents to a new temporary file, and return its path.
+str_t _write_temp_file(str_t contents) {
+  str_t path = (str_t) memory_malloc(32);
+  strcpy(path, "/tmp/mapped_file.XXXXXX");
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  size_t n = strlen(contents);
+  assert(write(fd, contents, n) == n);
+  close(fd);
+  return path;
+}
+
+void test_mapped_file_lines() {
+  printf("mapped file lines\n");
+
+  str_t contents = "GET /index.html\nPOST /cart\n\nGET /checkout\n";
+  str_t path = _write_temp_file(contents);
+  mapped_file_t *F = mapped_file_open(path, true);
+  assert(F);
+  assert(mapped_file_len(F) == strlen(contents));
+  assert(str_view_eq(mapped_file_view(F), str_view(contents)));
+
+  // Same lines as str_splitlines.
+  list_t *L = str_splitlines(contents);
+  str_split_iter_t It;
+  size_t i = 0;
+  mapped_file_lines_init(&It, F);
+  while (str_split_iter_next(&It)) {
+    assert(str_view_eq(str_split_iter_token(&It), str_view(str_unwrap(list_get(L, i)))));
+    i++;
+  }
+  assert(i == list_len(L));
+  list_total_destroy(L, str_destroy);
+
+  i = 0;
+  mapped_file_records_init(&It, F, str_view(" /"));
+  while (str_split_iter_next(&It)) {
+    i++;
+  }
+  assert(i == 4);
+
+  mapped_file_close(F);
+  unlink(path);
+  memory_free(path);
+}
+
+void test_mapped_file_edge_cases() {
+  printf("mapped file edge cases\n");
+
+  str_t path = _write_temp_file("");
+  mapped_file_t *F = mapped_file_open(path, false);
+  assert(F);
+  assert(mapped_file_len(F) == 0);
+  str_split_iter_t It;
+  mapped_file_lines_init(&It, F);
+  assert(!str_split_iter_next(&It));
+  mapped_file_close(F);
+  unlink(path);
+  memory_free(path);
+
+  assert(mapped_file_open("/tmp/mapped_file.missing", false) == NULL);
+
+  // Not regular files.
+  assert(mapped_file_open("/tmp", false) == NULL);
+  char fifo[] = "/tmp/mapped_file.fifo.XXXXXX";
+  assert(mkdtemp(fifo) != NULL);
+  assert(rmdir(fifo) == 0);
+  assert(mkfifo(fifo, 0600) == 0);
+  assert(mapped_file_open(fifo, false) == NULL);
+  unlink(fifo);
+
+  F = mapped_file_open("/proc/self/status", false);
+  assert(F);
+  assert(mapped_file_len(F) == 0);
+  mapped_file_close(F);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_mapped_file_lines();
+  test_mapped_file_edge_cases();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
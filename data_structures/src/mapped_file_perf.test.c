@@ -0,0 +1,88 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/list_extended.h"
+#include "../include/str.h"
+#include "../include/mapped_file.h"
+
+// Write about n bytes of log lines to path, and return the exact size.
+size_t _write_log_file(str_t path, size_t n) {
+  FILE *f = fopen(path, "w");
+  assert(f);
+  size_t written = 0;
+  int line_num = 0;
+  while (written < n) {
+    written += fprintf(f, "%d GET /index.html?session=%d 200 OK in %d ms\n", line_num, line_num * 31, line_num % 997);
+    line_num++;
+  }
+  fclose(f);
+  return written;
+}
+
+// Count the lines of a file of N bytes, by reading it into a str_t
+// and calling str_splitlines, and through a mapped_file_t.
+void test_mapped_file_lines_performance() {
+  int MAG = 3;
+  str_t path = "/tmp/mapped_file_perf.log";
+  size_t n;
+  size_t num_lines;
+  size_t expected;
+  clock_t start;
+  clock_t end;
+
+  size_t N = 128 << 20;
+
+  for (int i = 0; i < MAG; i++) {
+    n = _write_log_file(path, N);
+    printf("# BYTES: %lu\n", n);
+
+    start = clock();
+    int fd = open(path, O_RDONLY);
+    assert(fd >= 0);
+    str_t s = (str_t) memory_malloc(n + 1);
+    size_t num_read = 0;
+    ssize_t r;
+    while (num_read < n && (r = read(fd, s + num_read, n - num_read)) > 0) {
+      num_read += r;
+    }
+    close(fd);
+    s[num_read] = '\0';
+    list_t *L = str_splitlines(s);
+    expected = list_len(L);
+    end = clock();
+    printf("SECS (READ + SPLITLINES): %lf\n", ((double) (end - start)) / CLOCKS_PER_SEC);
+    list_total_destroy(L, str_destroy);
+    memory_free(s);
+
+    start = clock();
+    mapped_file_t *F = mapped_file_open(path, true);
+    assert(F);
+    num_lines = 0;
+    str_split_iter_t It;
+    mapped_file_lines_init(&It, F);
+    while (str_split_iter_next(&It)) {
+      num_lines++;
+    }
+    mapped_file_close(F);
+    end = clock();
+    printf("SECS (MAPPED FILE LINES): %lf\n", ((double) (end - start)) / CLOCKS_PER_SEC);
+    assert(num_lines == expected);
+    printf("# LINES: %lu\n", num_lines);
+
+    unlink(path);
+
+    N *= 2;
+  }
+}
+
+int main() {
+  test_mapped_file_lines_performance();
+
+  return 0;
+}
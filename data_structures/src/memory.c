@@ -1,4 +1,6 @@
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -144,7 +146,12 @@ addr_t _linked_list_remove(_linked_list *LL, addr_t e, bool (*entry_eq) (addr_t
 }
 
 _linked_list *memory_pointers_record = NULL;
-size_t total_memory_count = 0;
+// Guards memory_pointers_record, so that tests can allocate from several threads.
+pthread_mutex_t memory_pointers_lock = PTHREAD_MUTEX_INITIALIZER;
+// Counted whether or not pointers are recorded, so it is atomic rather
+// than taking the lock on every allocation. Relaxed, since it only
+// orders against itself.
+atomic_size_t total_memory_count = 0;
 
 bool _addr_eq(addr_t A1, addr_t A2) {
   return A1 == A2;
@@ -177,19 +184,21 @@ void memory_pointers_finish() {
 }
 
 void memory_count_reset() {
-  total_memory_count = 0;
+  atomic_store_explicit(&total_memory_count, 0, memory_order_relaxed);
 }
 
 size_t memory_count_report() {
-  return total_memory_count;
+  return atomic_load_explicit(&total_memory_count, memory_order_relaxed);
 }
 
 addr_t memory_malloc(size_t num_bytes) {
   addr_t p = malloc(num_bytes);  
   assert(p);
-  total_memory_count += num_bytes;
+  atomic_fetch_add_explicit(&total_memory_count, num_bytes, memory_order_relaxed);
   if (memory_pointers_record != NULL) {
+    pthread_mutex_lock(&memory_pointers_lock);
     _linked_list_push(memory_pointers_record, p);
+    pthread_mutex_unlock(&memory_pointers_lock);
   }
   return p;
 }
@@ -197,9 +206,11 @@ addr_t memory_malloc(size_t num_bytes) {
 addr_t memory_calloc(size_t num_entries, size_t num_bytes) {
   addr_t p = calloc(num_entries, num_bytes);  
   assert(p);
-  total_memory_count += num_entries * num_bytes;
+  atomic_fetch_add_explicit(&total_memory_count, num_entries * num_bytes, memory_order_relaxed);
   if (memory_pointers_record != NULL) {
+    pthread_mutex_lock(&memory_pointers_lock);
     _linked_list_push(memory_pointers_record, p);
+    pthread_mutex_unlock(&memory_pointers_lock);
   }
   return p;
 }
@@ -207,7 +218,9 @@ addr_t memory_calloc(size_t num_entries, size_t num_bytes) {
 void memory_free(addr_t p) {
   assert(p);
   if (memory_pointers_record != NULL) {
+    pthread_mutex_lock(&memory_pointers_lock);
     _linked_list_remove(memory_pointers_record, p, _addr_eq);
+    pthread_mutex_unlock(&memory_pointers_lock);
   }
   free(p);
 }
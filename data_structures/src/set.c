@@ -1,23 +1,225 @@
 #include <assert.h>
+#include <stdint.h>
 
-#include "../include/dict.h"
-#include "../include/dict_extended.h"
-#include "../include/item.h"
+#include "../include/hash.h"
 #include "../include/list.h"
 #include "../include/memory.h"
 #include "../include/set.h"
 
-const addr_t DEFAULT_VALUE = (addr_t) 1;
+#define SET_SMALL_CAPACITY 8
 
 struct _impl_set_t {
-  dict_t *D;
+  /* Open addressing over a table of entries, with linear probing.
+   *
+   * Only the entries themselves and their hashes are stored,
+   * so there is no value or per-entry allocation to carry around.
+   * An empty slot holds NULL. The full hash of each entry is kept
+   * next to it, so that entry_eq is only called when the hashes match
+   * and resizing never has to call hash again.
+   *
+   * The capacity m is a power of two, and is kept so that n <= 3/4 m.
+   * Deleting shifts later entries of the probe sequence back,
+   * so no tombstones are needed.
+   *
+   * Like dict_t, sets of up to SET_SMALL_CAPACITY entries are kept in
+   * a flat array in insertion order instead; then capacity is 0.
+   */
+  size_t len;
+  size_t capacity;
+  addr_t *entries;
+  size_t *hashes;
+  addr_t small[SET_SMALL_CAPACITY];
+  size_t small_hashes[SET_SMALL_CAPACITY];
+  bool (*entry_eq) (addr_t e1, addr_t e2);
+  size_t (*hash) (addr_t e);
 };
 
+bool _set_is_small(set_t *S) {
+  return S->capacity == 0;
+}
+
+size_t _set_home(size_t capacity, size_t hash) {
+  assert((capacity & (capacity - 1)) == 0);
+  return hash_slot(hash, capacity);
+}
+
+// Place e in the first free slot of its probe sequence.
+// e must not be in the table already.
+void _set_place(set_t *S, addr_t e, size_t hash) {
+  size_t mask = S->capacity - 1;
+  size_t i = _set_home(S->capacity, hash);
+  while (S->entries[i] != NULL) {
+    i = (i + 1) & mask;
+  }
+  S->entries[i] = e;
+  S->hashes[i] = hash;
+}
+
+// Rebuild S with new_capacity slots,
+// or as a small set if new_capacity is 0.
+void _set_rebuild(set_t *S, size_t new_capacity) {
+  addr_t *old_entries = S->entries;
+  size_t *old_hashes = S->hashes;
+  size_t old_capacity = S->capacity;
+
+  // Going from small to small leaves nothing to move.
+  if (old_capacity == 0 && new_capacity == 0) {
+    return;
+  }
+
+  S->capacity = new_capacity;
+  S->entries = NULL;
+  S->hashes = NULL;
+  if (new_capacity > 0) {
+    S->entries = (addr_t *) memory_calloc(new_capacity, sizeof(addr_t));
+    S->hashes = (size_t *) memory_malloc(new_capacity * sizeof(size_t));
+  }
+
+  size_t n = 0;
+  if (old_capacity == 0) {
+    for (size_t i = 0; i < S->len; i++) {
+      _set_place(S, S->small[i], S->small_hashes[i]);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_entries[i] == NULL) {
+      continue;
+    }
+    if (new_capacity == 0) {
+      assert(n < SET_SMALL_CAPACITY);
+      S->small[n] = old_entries[i];
+      S->small_hashes[n] = old_hashes[i];
+      n++;
+    } else {
+      _set_place(S, old_entries[i], old_hashes[i]);
+    }
+  }
+  memory_free(old_entries);
+  memory_free(old_hashes);
+}
+
+// Smallest table that holds n entries at most 3/4 full.
+size_t _set_capacity_for(size_t n) {
+  size_t capacity = 16;
+  while (capacity / 4 * 3 < n) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+// Make room for S to hold new_len entries,
+// or give back room once it holds far fewer.
+void _set_resize(set_t *S, size_t new_len) {
+  if (_set_is_small(S)) {
+    if (new_len > SET_SMALL_CAPACITY) {
+      _set_rebuild(S, _set_capacity_for(new_len));
+    }
+  } else if (S->capacity / 4 * 3 < new_len) {
+    _set_rebuild(S, S->capacity * 2);
+  } else if (new_len > S->len) {
+    // Never shrink while growing, which would undo set_reserve.
+    return;
+  } else if (new_len <= SET_SMALL_CAPACITY / 2) {
+    _set_rebuild(S, 0);
+  } else if (new_len < S->capacity / 8) {
+    _set_rebuild(S, _set_capacity_for(new_len));
+  }
+}
+
+// If e is in S, set *i to its slot, or to its position if S is small,
+// and return true.
+bool _set_find(set_t *S, addr_t e, size_t hash, size_t *i) {
+  if (_set_is_small(S)) {
+    for (size_t j = 0; j < S->len; j++) {
+      if (S->small_hashes[j] == hash && S->entry_eq(S->small[j], e)) {
+        *i = j;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  size_t mask = S->capacity - 1;
+  size_t j = _set_home(S->capacity, hash);
+  while (S->entries[j] != NULL) {
+    if (S->hashes[j] == hash && S->entry_eq(S->entries[j], e)) {
+      *i = j;
+      return true;
+    }
+    j = (j + 1) & mask;
+  }
+  return false;
+}
+
+// Add e, which must not be in S already.
+void _set_push(set_t *S, addr_t e, size_t hash) {
+  _set_resize(S, S->len + 1);
+  if (_set_is_small(S)) {
+    S->small[S->len] = e;
+    S->small_hashes[S->len] = hash;
+  } else {
+    _set_place(S, e, hash);
+  }
+  S->len++;
+}
+
+addr_t _set_entry_at(set_t *S, size_t i) {
+  if (_set_is_small(S)) {
+    return S->small[i];
+  }
+  return S->entries[i];
+}
+
+size_t _set_hash_at(set_t *S, size_t i) {
+  if (_set_is_small(S)) {
+    return S->small_hashes[i];
+  }
+  return S->hashes[i];
+}
+
+// Remove the entry at i, as found by _set_find, and return it.
+// Does not resize S.
+addr_t _set_remove_at(set_t *S, size_t i) {
+  addr_t k;
+  if (_set_is_small(S)) {
+    // Shift the rest down to keep insertion order.
+    k = S->small[i];
+    for (size_t j = i + 1; j < S->len; j++) {
+      S->small[j - 1] = S->small[j];
+      S->small_hashes[j - 1] = S->small_hashes[j];
+    }
+  } else {
+    k = S->entries[i];
+    size_t mask = S->capacity - 1;
+    size_t j = i;
+    while (true) {
+      j = (j + 1) & mask;
+      if (S->entries[j] == NULL) {
+        break;
+      }
+      if (hash_slot_can_shift(i, j, _set_home(S->capacity, S->hashes[j]))) {
+        S->entries[i] = S->entries[j];
+        S->hashes[i] = S->hashes[j];
+        i = j;
+      }
+    }
+    S->entries[i] = NULL;
+  }
+  S->len--;
+  return k;
+}
+
 set_t *set_create(bool (*entry_eq) (addr_t e1, addr_t e2), size_t (*hash) (addr_t e)) {
   set_t *S = (set_t *) memory_malloc(sizeof(set_t));
 
-  dict_t *D = dict_create(entry_eq, hash);
-  S->D = D;
+  S->len = 0;
+  S->capacity = 0;
+  S->entries = NULL;
+  S->hashes = NULL;
+  S->entry_eq = entry_eq;
+  S->hash = hash;
 
   return S;
 }
@@ -25,57 +227,285 @@ set_t *set_create(bool (*entry_eq) (addr_t e1, addr_t e2), size_t (*hash) (addr_
 void set_destroy(set_t *S) {
   assert(S);
 
-  dict_destroy(S->D);
-  memory_free(S); 
+  if (!_set_is_small(S)) {
+    memory_free(S->entries);
+    memory_free(S->hashes);
+  }
+  memory_free(S);
 }
 
 addr_t set_key_eq(set_t *S) {
   assert(S);
 
-  return dict_key_eq(S->D);
+  return S->entry_eq;
 }
 
 addr_t set_hash(set_t *S) {
   assert(S);
 
-  return dict_key_hash(S->D);
+  return S->hash;
 }
 
 size_t set_len(set_t *S) {
   assert(S);
 
-  size_t len = dict_len(S->D);
-  return len;
+  return S->len;
 }
 
 bool set_includes(set_t *S, addr_t e) {
   assert(S);
 
-  addr_t v = dict_get(S->D, e);
-  return v != NULL;
+  if (S->len == 0) {
+    return false;
+  }
+
+  return set_includes_hashed(S, e, S->hash(e));
+}
+
+bool set_includes_hashed(set_t *S, addr_t e, size_t hash) {
+  assert(S);
+
+  if (S->len == 0) {
+    return false;
+  }
+
+  size_t i;
+  return _set_find(S, e, hash, &i);
 }
 
 list_t *set_to_list(set_t *S) {
   assert(S);
 
-  list_t *keys = dict_keys(S->D);
-  return keys;
+  list_t *entries = list_create(S->len);
+
+  size_t i = 0;
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    list_set(entries, i, set_iter_entry(&It));
+    i++;
+  }
+  return entries;
+}
+
+void set_iter_init(set_iter_t *It, set_t *S) {
+  assert(It);
+  assert(S);
+
+  It->S = S;
+  It->index = 0;
+  It->e = NULL;
+}
+
+bool set_iter_next(set_iter_t *It) {
+  assert(It);
+
+  set_t *S = It->S;
+  if (_set_is_small(S)) {
+    if (It->index < S->len) {
+      It->e = S->small[It->index];
+      It->index++;
+      return true;
+    }
+    It->e = NULL;
+    return false;
+  }
+
+  while (It->index < S->capacity) {
+    It->e = S->entries[It->index];
+    It->index++;
+    if (It->e != NULL) {
+      return true;
+    }
+  }
+  It->e = NULL;
+  return false;
+}
+
+addr_t set_iter_entry(set_iter_t *It) {
+  assert(It);
+  assert(It->e);
+
+  return It->e;
+}
+
+addr_t set_get(set_t *S, addr_t e) {
+  assert(S);
+
+  size_t i;
+  if (S->len == 0 || !_set_find(S, e, S->hash(e), &i)) {
+    return NULL;
+  }
+  return _set_entry_at(S, i);
 }
 
 void set_add(set_t *S, addr_t e) {
   assert(S);
+  assert(e);
 
-  dict_set(S->D, e, DEFAULT_VALUE);
+  size_t hash = S->hash(e);
+  size_t i;
+  if (S->len > 0 && _set_find(S, e, hash, &i)) {
+    return;
+  }
+  _set_push(S, e, hash);
 }
 
 addr_t set_remove(set_t *S, addr_t e) {
   assert(S);
 
-  item_t *I = dict_del(S->D, e);
-  addr_t k = NULL;
-  if (I != NULL) {
-    k = item_get_key(I);
-    item_destroy(I);
+  if (S->len == 0) {
+    return NULL;
+  }
+
+  size_t i;
+  if (!_set_find(S, e, S->hash(e), &i)) {
+    return NULL;
   }
+
+  addr_t k = _set_remove_at(S, i);
+  _set_resize(S, S->len);
   return k;
 }
+
+void set_reserve(set_t *S, size_t n) {
+  assert(S);
+
+  if (n <= SET_SMALL_CAPACITY) {
+    return;
+  }
+  size_t new_capacity = _set_capacity_for(n);
+  if (new_capacity > S->capacity) {
+    _set_rebuild(S, new_capacity);
+  }
+}
+
+/* Both sets must share a hash function,
+ * so that the hashes cached in T can be used for S directly.
+ */
+void set_union_into(set_t *S, set_t *T) {
+  assert(S);
+  assert(T);
+  assert(S->hash == T->hash);
+
+  set_reserve(S, S->len + T->len);
+
+  size_t num_slots = _set_is_small(T) ? T->len : T->capacity;
+  addr_t e;
+  size_t hash;
+  size_t i;
+  for (size_t j = 0; j < num_slots; j++) {
+    e = _set_entry_at(T, j);
+    if (e == NULL) {
+      continue;
+    }
+    hash = _set_hash_at(T, j);
+    if (S->len == 0 || !_set_find(S, e, hash, &i)) {
+      _set_push(S, e, hash);
+    }
+  }
+
+  // Give back the reserved room if most of T was already in S.
+  _set_resize(S, S->len);
+}
+
+void set_intersect_inplace(set_t *S, set_t *T) {
+  assert(S);
+  assert(T);
+  assert(S->hash == T->hash);
+
+  size_t i;
+  size_t j;
+  if (S->len <= T->len) {
+    // Probe T for each entry of S, removing the ones it lacks.
+    // Removing only ever moves entries back into the current slot,
+    // or wraps them around to slots that are already checked,
+    // so stay on a slot after removing from it.
+    j = 0;
+    while (j < (_set_is_small(S) ? S->len : S->capacity)) {
+      addr_t e = _set_entry_at(S, j);
+      if (e != NULL && (T->len == 0 || !_set_find(T, e, _set_hash_at(S, j), &i))) {
+        _set_remove_at(S, j);
+      } else {
+        j++;
+      }
+    }
+    _set_resize(S, S->len);
+    return;
+  }
+
+  // T is smaller, so probe S for each entry of T,
+  // keeping the matching entries of S in a table sized for T.
+  set_t old = *S;
+  S->len = 0;
+  S->capacity = 0;
+  S->entries = NULL;
+  S->hashes = NULL;
+  set_reserve(S, T->len);
+
+  size_t num_slots = _set_is_small(T) ? T->len : T->capacity;
+  size_t hash;
+  for (j = 0; j < num_slots; j++) {
+    if (_set_entry_at(T, j) == NULL) {
+      continue;
+    }
+    hash = _set_hash_at(T, j);
+    if (_set_find(&old, _set_entry_at(T, j), hash, &i)) {
+      _set_push(S, _set_entry_at(&old, i), hash);
+    }
+  }
+
+  if (!_set_is_small(&old)) {
+    memory_free(old.entries);
+    memory_free(old.hashes);
+  }
+  _set_resize(S, S->len);
+}
+
+/* Entries are hashed SET_PREFETCH_DISTANCE positions ahead of the one
+ * being probed, so that its home slot is already on its way from memory.
+ */
+#define SET_PREFETCH_DISTANCE 8
+
+#if defined(__GNUC__)
+#define _set_prefetch(p) __builtin_prefetch(p)
+#else
+#define _set_prefetch(p)
+#endif
+
+size_t _set_load_hash(set_t *S, list_t *entries, size_t i) {
+  size_t hash = S->hash(list_get(entries, i));
+  if (!_set_is_small(S)) {
+    _set_prefetch(&S->entries[_set_home(S->capacity, hash)]);
+  }
+  return hash;
+}
+
+list_t *set_includes_many(set_t *S, list_t *entries) {
+  assert(S);
+  assert(entries);
+
+  size_t n = list_len(entries);
+  list_t *found = list_create(n);
+  if (S->len == 0) {
+    return found;
+  }
+
+  size_t hashes[SET_PREFETCH_DISTANCE];
+  for (size_t j = 0; j < SET_PREFETCH_DISTANCE && j < n; j++) {
+    hashes[j] = _set_load_hash(S, entries, j);
+  }
+
+  size_t i;
+  size_t hash;
+  for (size_t j = 0; j < n; j++) {
+    hash = hashes[j % SET_PREFETCH_DISTANCE];
+    if (j + SET_PREFETCH_DISTANCE < n) {
+      hashes[j % SET_PREFETCH_DISTANCE] = _set_load_hash(S, entries, j + SET_PREFETCH_DISTANCE);
+    }
+    if (_set_find(S, list_get(entries, j), hash, &i)) {
+      list_set(found, j, _set_entry_at(S, i));
+    }
+  }
+  return found;
+}
@@ -127,6 +127,36 @@ void test_set_to_list() {
   set_total_destroy(S, memory_free);
 }
 
+void test_set_iter() {
+  printf("set iter\n");
+
+  set_t *S = set_create(int_eq, int_hash);
+  set_iter_t It;
+  size_t num_bytes_used;
+
+  set_iter_init(&It, S);
+  assert(set_iter_next(&It) == false);
+
+  for (int i = 0; i < 50; i++) {
+    set_add(S, int_wrap(i));
+  }
+
+  memory_count_reset();
+  size_t count = 0;
+  int sum = 0;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    sum += int_unwrap(set_iter_entry(&It));
+    count++;
+  }
+  num_bytes_used = memory_count_report();
+  assert(count == 50);
+  assert(sum == 50 * 49 / 2);
+  assert(num_bytes_used == 0);
+
+  set_total_destroy(S, memory_free);
+}
+
 void test_set_copy() {
   printf("set copy\n");
 
@@ -304,17 +334,185 @@ void test_set_difference() {
   set_destroy(D);
 }
 
+void test_big_set() {
+  printf("big set\n");
+
+  size_t N = 10000;
+  addr_t e;
+
+  set_t *S = set_create(int_eq, int_hash);
+  for (int i = 0; i < N; i++) {
+    set_add(S, int_wrap(i));
+  }
+  assert(set_len(S) == N);
+
+  // Remove every other entry, which shifts the rest of each probe run back.
+  for (int i = 0; i < N; i += 2) {
+    e = int_wrap(i);
+    memory_free(set_remove(S, e));
+    memory_free(e);
+  }
+  assert(set_len(S) == N / 2);
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    assert(set_includes(S, e) == (i % 2 == 1));
+    memory_free(e);
+  }
+
+  // Shrink back down to a small set.
+  for (int i = 1; i < N - 2; i += 2) {
+    e = int_wrap(i);
+    memory_free(set_remove(S, e));
+    memory_free(e);
+  }
+  assert(set_len(S) == 1);
+  str_t actual = set_string(S, int_str);
+  assert(strcmp(actual, "{9999}") == 0);
+  memory_free(actual);
+  set_total_destroy(S, memory_free);
+
+  // Entries are stored directly, with no per-entry allocation.
+  S = set_create(int_eq, int_hash);
+  list_t *L = list_create(N);
+  for (int i = 0; i < N; i++) {
+    list_set(L, i, int_wrap(i));
+  }
+  memory_count_reset();
+  for (int i = 0; i < N; i++) {
+    set_add(S, list_get(L, i));
+  }
+  size_t num_bytes_used = memory_count_report();
+  // At most 2N slots of an entry and a hash each, plus the smaller tables.
+  assert(num_bytes_used <= 2 * 2 * N * (sizeof(addr_t) + sizeof(size_t)));
+  set_total_destroy(S, memory_free);
+  list_destroy(L);
+}
+
+void test_set_algebra_inplace() {
+  printf("set algebra in place\n");
+
+  addr_t e;
+  bool is_in;
+
+  // Large on both sides, so both paths of set_intersect_inplace run.
+  // The entries of S1 are owned by E, since intersecting drops some.
+  size_t N = 1000;
+  list_t *E = list_create(N);
+  set_t *S1 = set_create(int_eq, int_hash);
+  set_t *S2 = set_create(int_eq, int_hash);
+  set_t *S3 = set_create(int_eq, int_hash);
+  for (int i = 0; i < N; i++) {
+    list_set(E, i, int_wrap(i));
+    set_add(S1, list_get(E, i));
+    set_add(S2, int_wrap(i + N / 2));
+  }
+  for (int i = 0; i < N; i += 10) {
+    set_add(S3, int_wrap(i));
+  }
+
+  // S2 keeps its entries, and S1 borrows the ones it lacked.
+  set_union_into(S1, S2);
+  assert(set_len(S1) == N + N / 2);
+  assert(set_len(S2) == N);
+  for (int i = 0; i < N + N / 2; i++) {
+    e = int_wrap(i);
+    is_in = set_includes(S1, e);
+    assert(is_in == true);
+    memory_free(e);
+  }
+
+  // S3 is smaller, so S1 is rebuilt from the entries of S3.
+  set_intersect_inplace(S1, S3);
+  assert(set_len(S1) == N / 10);
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    assert(set_includes(S1, e) == (i % 10 == 0));
+    assert(set_get(S1, e) != e);
+    memory_free(e);
+  }
+
+  // S1 is now no larger than S2, so it is filtered in place.
+  set_intersect_inplace(S1, S2);
+  assert(set_len(S1) == N / 20);
+  for (int i = 0; i < N; i++) {
+    e = int_wrap(i);
+    assert(set_includes(S1, e) == (i % 10 == 0 && i >= N / 2));
+    memory_free(e);
+  }
+
+  list_t *L = list_create(0);
+  list_t *found = set_includes_many(S1, L);
+  assert(list_len(found) == 0);
+  list_destroy(found);
+  for (int i = N / 2; i < N; i += 10) {
+    list_push(L, int_wrap(i));
+  }
+  size_t n = list_len(L);
+  list_push(L, int_wrap(1));
+  list_push(L, int_wrap(N / 2));
+  found = set_includes_many(S1, L);
+  assert(list_len(found) == n + 2);
+  for (size_t i = 0; i < n + 2; i++) {
+    if (i == n) {
+      assert(list_get(found, i) == NULL);
+    } else {
+      // The entry stored in S1, not the one looked up.
+      assert(list_get(found, i) != list_get(L, i));
+      assert(int_unwrap(list_get(found, i)) == int_unwrap(list_get(L, i)));
+    }
+  }
+  list_destroy(found);
+  set_t *empty = set_create(int_eq, int_hash);
+  found = set_includes_many(empty, L);
+  assert(list_len(found) == n + 2);
+  assert(list_get(found, 0) == NULL);
+  list_destroy(found);
+  set_destroy(empty);
+  list_total_destroy(L, memory_free);
+
+  set_destroy(S1);
+  list_total_destroy(E, memory_free);
+  set_total_destroy(S2, memory_free);
+  set_total_destroy(S3, memory_free);
+}
+
+void test_set_reserve() {
+  printf("set reserve\n");
+
+  size_t N = 1000;
+  set_t *S = set_create(int_eq, int_hash);
+  list_t *L = list_create(N);
+  for (int i = 0; i < N; i++) {
+    list_set(L, i, int_wrap(i));
+  }
+
+  set_reserve(S, N);
+  memory_count_reset();
+  for (int i = 0; i < N; i++) {
+    set_add(S, list_get(L, i));
+  }
+  assert(memory_count_report() == 0);
+  assert(set_len(S) == N);
+
+  set_destroy(S);
+  list_total_destroy(L, memory_free);
+}
+
 int main() {
   memory_pointers_init();
 
   test_basic_set();
+  test_big_set();
   test_set_to_list();
   test_set_from_list();
+  test_set_iter();
   test_set_copy();
   test_set_deep_copy();
   test_set_union();
   test_set_intersection();
   test_set_difference();
+  test_set_algebra_inplace();
+  test_set_reserve();
 
   str_t usage = memory_pointers_report();
   str_t expected = "->";
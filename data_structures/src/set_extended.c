@@ -3,53 +3,40 @@
 #include "../include/item.h"
 #include "../include/list_extended.h"
 #include "../include/memory.h"
+#include "../include/str.h"
 #include "../include/set.h"
 
 void set_total_destroy(set_t *S, void (*entry_destroy)(addr_t e)) {
   assert(S);
 
-  list_t *entries = set_to_list(S);
-  list_total_destroy(entries, entry_destroy);
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    entry_destroy(set_iter_entry(&It));
+  }
   set_destroy(S);
 }
 
 str_t set_string(set_t *S, str_t (*entry_string)(addr_t e)) {
   assert(S);
 
-  list_t *entries = set_to_list(S);
-
-  addr_t e;
-  str_t e_str;
-  size_t e_len;
-
-  size_t total_size = 0;
-  for (int i = 0; i < list_len(entries); i++) {
-    e = list_get(entries, i);
-    e_str = entry_string(e);
-    e_len = strlen(e_str);
-    memory_free(e_str);
-    total_size += e_len + 1; // +1 for comma
-  }
-
-  str_t res = (str_t) memory_calloc(total_size + 2 + 1, sizeof(char)); // +2 for brackets, +1 for \0
-  strncat(res, "{", 1);
+  str_buf_t *B = str_buf_create(0);
+  str_buf_append_char(B, '{');
 
-  for (int i = 0; i < list_len(entries); i++) {
-    e = list_get(entries, i);
-    e_str = entry_string(e);
-    e_len = strlen(e_str);
-    if (i != 0) {
-      strncat(res, ",", 1);
+  bool first = true;
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    if (!first) {
+      str_buf_append_char(B, ',');
     }
-    strncat(res, e_str, e_len);
-    memory_free(e_str);
+    str_buf_append_owned(B, entry_string(set_iter_entry(&It)));
+    first = false;
   }
 
-  strncat(res, "}", 1);
+  str_buf_append_char(B, '}');
 
-  list_destroy(entries);
-
-  return res;
+  return str_buf_finish(B);
 }
 
 set_t *set_union(set_t *S1, set_t *S2, bool (*entry_eq) (addr_t e1, addr_t e2), size_t (*hash) (addr_t e)) {
@@ -57,22 +44,19 @@ set_t *set_union(set_t *S1, set_t *S2, bool (*entry_eq) (addr_t e1, addr_t e2),
   assert(S2);
 
   set_t *S = set_create(entry_eq, hash);
+  set_reserve(S, set_len(S1) + set_len(S2));
 
-  addr_t e;
+  set_iter_t It;
 
-  list_t *L1 = set_to_list(S1);
-  for (int i = 0; i < list_len(L1); i++) {
-    e = list_get(L1, i);
-    set_add(S, e);
+  set_iter_init(&It, S1);
+  while (set_iter_next(&It)) {
+    set_add(S, set_iter_entry(&It));
   }
-  list_destroy(L1);
 
-  list_t *L2 = set_to_list(S2);
-  for (int i = 0; i < list_len(L2); i++) {
-    e = list_get(L2, i);
-    set_add(S, e);
+  set_iter_init(&It, S2);
+  while (set_iter_next(&It)) {
+    set_add(S, set_iter_entry(&It));
   }
-  list_destroy(L2);
 
   return S;
 }
@@ -84,15 +68,27 @@ set_t *set_intersection(set_t *S1, set_t *S2, bool (*entry_eq) (addr_t e1, addr_
   set_t *S = set_create(entry_eq, hash);
 
   addr_t e;
-
-  list_t *L1 = set_to_list(S1);
-  for (int i = 0; i < list_len(L1); i++) {
-    e = list_get(L1, i);
-    if (set_includes(S2, e)) {
-      set_add(S, e);
+  set_iter_t It;
+  if (set_len(S1) <= set_len(S2)) {
+    set_reserve(S, set_len(S1));
+    set_iter_init(&It, S1);
+    while (set_iter_next(&It)) {
+      e = set_iter_entry(&It);
+      if (set_includes(S2, e)) {
+        set_add(S, e);
+      }
+    }
+  } else {
+    // Walk the smaller set, but still keep the entries of S1.
+    set_reserve(S, set_len(S2));
+    set_iter_init(&It, S2);
+    while (set_iter_next(&It)) {
+      e = set_get(S1, set_iter_entry(&It));
+      if (e != NULL) {
+        set_add(S, e);
+      }
     }
   }
-  list_destroy(L1);
 
   return S;
 }
@@ -102,17 +98,17 @@ set_t *set_difference(set_t *S1, set_t *S2, bool (*entry_eq) (addr_t e1, addr_t
   assert(S2);
 
   set_t *S = set_create(entry_eq, hash);
+  set_reserve(S, set_len(S1));
 
   addr_t e;
-
-  list_t *L1 = set_to_list(S1);
-  for (int i = 0; i < list_len(L1); i++) {
-    e = list_get(L1, i);
+  set_iter_t It;
+  set_iter_init(&It, S1);
+  while (set_iter_next(&It)) {
+    e = set_iter_entry(&It);
     if (!set_includes(S2, e)) {
       set_add(S, e);
     }
   }
-  list_destroy(L1);
 
   return S;
 }
@@ -121,6 +117,7 @@ set_t *set_from_list(list_t *L, bool (*entry_eq) (addr_t e1, addr_t e2), size_t
   assert(L);
 
   set_t *S = set_create(entry_eq, hash);
+  set_reserve(S, list_len(L));
 
   addr_t e;
   for (int i = 0; i < list_len(L); i++) {
@@ -134,9 +131,14 @@ set_t *set_from_list(list_t *L, bool (*entry_eq) (addr_t e1, addr_t e2), size_t
 set_t *set_copy(set_t *S) {
   assert(S);
 
-  list_t *entries = set_to_list(S);
-  set_t *C = set_from_list(entries, set_key_eq(S), set_hash(S));
-  list_destroy(entries);
+  set_t *C = set_create(set_key_eq(S), set_hash(S));
+  set_reserve(C, set_len(S));
+
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    set_add(C, set_iter_entry(&It));
+  }
 
   return C;
 }
@@ -144,11 +146,14 @@ set_t *set_copy(set_t *S) {
 set_t *set_deep_copy(set_t *S, addr_t (*entry_copy)(addr_t e)) {
   assert(S);
 
-  list_t *entries = set_to_list(S);
-  list_t *entries_copied = list_deep_copy(entries, entry_copy);
-  set_t *C = set_from_list(entries_copied, set_key_eq(S), set_hash(S));
-  list_destroy(entries_copied);
-  list_destroy(entries);
+  set_t *C = set_create(set_key_eq(S), set_hash(S));
+  set_reserve(C, set_len(S));
+
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    set_add(C, entry_copy(set_iter_entry(&It)));
+  }
 
   return C;
 }
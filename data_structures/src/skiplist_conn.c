@@ -0,0 +1,475 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "../include/memory.h"
+#include "../include/skiplist_conn.h"
+
+/* Lazy skiplist (Herlihy, Lev, Luchangco and Shavit).
+ *
+ * Readers walk the next pointers with atomic loads and take no locks.
+ * A writer finds the predecessors of its key at every level, locks
+ * only those, checks they are still unmarked and still point where
+ * they did, and then links or unlinks its node from the bottom up
+ * (or the top down), so readers always see a sorted list.
+ *
+ * A node is in the map once fully_linked is set, and is out of it once
+ * marked is set. Removed nodes are not freed right away, since a
+ * reader may still be standing on one.
+ *
+ * Instead, they are reclaimed by epoch. Every reader and writer pins
+ * the current epoch for as long as it holds nodes, counting itself in
+ * num_pinned[epoch % 3]. A node unlinked during epoch e goes on
+ * retired[e % 3], and only a thread pinned at e or earlier can still
+ * reach it, since later ones start after it was unlinked. The epoch
+ * only moves from e to e + 1 once no thread is pinned at e - 1, so by
+ * then the nodes retired during e - 1 are unreachable and are freed.
+ */
+#define SKIPLIST_MAX_LEVEL 24
+
+struct _skiplist_node {
+  addr_t key;
+  _Atomic(addr_t) value;
+  int top_level;
+  atomic_bool marked;
+  atomic_bool fully_linked;
+  pthread_mutex_t lock;
+  struct _skiplist_node *retired_next;
+  // next[i] for i <= top_level.
+  _Atomic(struct _skiplist_node *) next[];
+};
+typedef struct _skiplist_node node;
+
+/* As with list_sort, compare(k1, k2) > 0 means k1 comes before k2.
+ * NULL next pointers end every level.
+ */
+struct _impl_skiplist_conn_t {
+  node *head;
+  atomic_size_t len;
+  atomic_uint_fast64_t seed;
+  atomic_uint_fast64_t epoch;
+  atomic_size_t num_pinned[3];
+  // Guards retired and the moves of epoch.
+  pthread_mutex_t retired_lock;
+  node *retired[3];
+  int (*compare)(addr_t k1, addr_t k2);
+};
+
+node *_skiplist_node_create(addr_t k, addr_t v, int top_level) {
+  node *N = (node *) memory_malloc(sizeof(node) + (top_level + 1) * sizeof(_Atomic(node *)));
+  N->key = k;
+  atomic_init(&N->value, v);
+  N->top_level = top_level;
+  atomic_init(&N->marked, false);
+  atomic_init(&N->fully_linked, false);
+  pthread_mutex_init(&N->lock, NULL);
+  N->retired_next = NULL;
+  for (int i = 0; i <= top_level; i++) {
+    atomic_init(&N->next[i], NULL);
+  }
+  return N;
+}
+
+void _skiplist_node_destroy(node *N) {
+  pthread_mutex_destroy(&N->lock);
+  memory_free(N);
+}
+
+skiplist_conn_t *skiplist_conn_create(int (*compare)(addr_t k1, addr_t k2)) {
+  skiplist_conn_t *SC = (skiplist_conn_t *) memory_malloc(sizeof(skiplist_conn_t));
+
+  SC->head = _skiplist_node_create(NULL, NULL, SKIPLIST_MAX_LEVEL - 1);
+  atomic_store(&SC->head->fully_linked, true);
+  atomic_init(&SC->len, 0);
+  atomic_init(&SC->seed, 0);
+  atomic_init(&SC->epoch, 0);
+  pthread_mutex_init(&SC->retired_lock, NULL);
+  for (int i = 0; i < 3; i++) {
+    atomic_init(&SC->num_pinned[i], 0);
+    SC->retired[i] = NULL;
+  }
+  SC->compare = compare;
+
+  return SC;
+}
+
+// Return the epoch pinned, to pass to _skiplist_unpin.
+uint64_t _skiplist_pin(skiplist_conn_t *SC) {
+  uint64_t e;
+  while (true) {
+    e = atomic_load(&SC->epoch);
+    atomic_fetch_add(&SC->num_pinned[e % 3], 1);
+    // If the epoch moved on before we were counted, it may have
+    // checked our count already, so count ourselves in the new one.
+    if (atomic_load(&SC->epoch) == e) {
+      return e;
+    }
+    atomic_fetch_sub(&SC->num_pinned[e % 3], 1);
+  }
+}
+
+void _skiplist_unpin(skiplist_conn_t *SC, uint64_t e) {
+  atomic_fetch_sub(&SC->num_pinned[e % 3], 1);
+}
+
+void _skiplist_free_retired(node *N, void (*key_destroy)(addr_t k)) {
+  node *next;
+  while (N != NULL) {
+    next = N->retired_next;
+    if (key_destroy != NULL) {
+      key_destroy(N->key);
+    }
+    _skiplist_node_destroy(N);
+    N = next;
+  }
+}
+
+void _skiplist_retire(skiplist_conn_t *SC, node *N) {
+  pthread_mutex_lock(&SC->retired_lock);
+  uint64_t e = atomic_load(&SC->epoch);
+  N->retired_next = SC->retired[e % 3];
+  SC->retired[e % 3] = N;
+  pthread_mutex_unlock(&SC->retired_lock);
+}
+
+// Move from epoch e to e + 1, freeing the nodes retired during e - 1,
+// unless a thread is still pinned at e - 1. Return whether it moved.
+bool _skiplist_advance(skiplist_conn_t *SC, void (*key_destroy)(addr_t k)) {
+  pthread_mutex_lock(&SC->retired_lock);
+  uint64_t e = atomic_load(&SC->epoch);
+  // (e + 2) % 3 is (e - 1) % 3, without wrapping at e = 0.
+  size_t prev = (e + 2) % 3;
+  if (atomic_load(&SC->num_pinned[prev]) != 0) {
+    pthread_mutex_unlock(&SC->retired_lock);
+    return false;
+  }
+  _skiplist_free_retired(SC->retired[prev], key_destroy);
+  SC->retired[prev] = NULL;
+  atomic_store(&SC->epoch, e + 1);
+  pthread_mutex_unlock(&SC->retired_lock);
+  return true;
+}
+
+// Nodes retired during the current epoch are freed after two moves.
+void skiplist_conn_reclaim(skiplist_conn_t *SC, void (*key_destroy)(addr_t k)) {
+  assert(SC);
+
+  for (int i = 0; i < 2 && _skiplist_advance(SC, key_destroy); i++) {
+  }
+}
+
+void skiplist_conn_total_destroy(skiplist_conn_t *SC, void (*key_destroy)(addr_t k), void (*value_destroy)(addr_t v)) {
+  assert(SC);
+
+  for (int i = 0; i < 3; i++) {
+    _skiplist_free_retired(SC->retired[i], key_destroy);
+  }
+  pthread_mutex_destroy(&SC->retired_lock);
+
+  node *N = atomic_load(&SC->head->next[0]);
+  node *next;
+  while (N != NULL) {
+    next = atomic_load(&N->next[0]);
+    if (key_destroy != NULL) {
+      key_destroy(N->key);
+    }
+    if (value_destroy != NULL) {
+      value_destroy(atomic_load(&N->value));
+    }
+    _skiplist_node_destroy(N);
+    N = next;
+  }
+  _skiplist_node_destroy(SC->head);
+  memory_free(SC);
+}
+
+void skiplist_conn_destroy(skiplist_conn_t *SC) {
+  skiplist_conn_total_destroy(SC, NULL, NULL);
+}
+
+size_t skiplist_conn_len(skiplist_conn_t *SC) {
+  assert(SC);
+  return atomic_load(&SC->len);
+}
+
+// Each level holds about a quarter of the nodes of the level below.
+int _skiplist_random_level(skiplist_conn_t *SC) {
+  uint64_t x = atomic_fetch_add(&SC->seed, 0x9e3779b97f4a7c15ull);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  x ^= x >> 31;
+
+  int level = 0;
+  while ((x & 3) == 0 && level < SKIPLIST_MAX_LEVEL - 1) {
+    x >>= 2;
+    level++;
+  }
+  return level;
+}
+
+/* Set preds[i] to the last node before k at level i, and succs[i] to
+ * the node after it. Return the highest level at which k was found,
+ * or -1.
+ */
+int _skiplist_find(skiplist_conn_t *SC, addr_t k, node **preds, node **succs) {
+  int found = -1;
+  node *pred = SC->head;
+  node *curr;
+  for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+    curr = atomic_load(&pred->next[level]);
+    while (curr != NULL && SC->compare(curr->key, k) > 0) {
+      pred = curr;
+      curr = atomic_load(&pred->next[level]);
+    }
+    if (found == -1 && curr != NULL && SC->compare(curr->key, k) == 0) {
+      found = level;
+    }
+    preds[level] = pred;
+    succs[level] = curr;
+  }
+  return found;
+}
+
+addr_t _skiplist_get(skiplist_conn_t *SC, addr_t k) {
+  node *pred = SC->head;
+  node *curr = NULL;
+  for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+    curr = atomic_load(&pred->next[level]);
+    while (curr != NULL && SC->compare(curr->key, k) > 0) {
+      pred = curr;
+      curr = atomic_load(&pred->next[level]);
+    }
+  }
+  if (curr == NULL || SC->compare(curr->key, k) != 0) {
+    return NULL;
+  }
+  if (!atomic_load(&curr->fully_linked) || atomic_load(&curr->marked)) {
+    return NULL;
+  }
+  return atomic_load(&curr->value);
+}
+
+addr_t skiplist_conn_get(skiplist_conn_t *SC, addr_t k) {
+  assert(SC);
+
+  uint64_t e = _skiplist_pin(SC);
+  addr_t v = _skiplist_get(SC, k);
+  _skiplist_unpin(SC, e);
+  return v;
+}
+
+// Unlock preds[0..top_level], each distinct node once.
+void _skiplist_unlock(node **preds, int top_level) {
+  node *prev = NULL;
+  for (int level = 0; level <= top_level; level++) {
+    if (preds[level] != prev) {
+      pthread_mutex_unlock(&preds[level]->lock);
+      prev = preds[level];
+    }
+  }
+}
+
+/* Lock preds[0..top_level] from the bottom up, which is from the
+ * largest key down, as every writer does, so that writers cannot
+ * deadlock. Return whether every pred still points to succs[level]
+ * and neither is marked, except for the victim being removed.
+ * If not, leave them unlocked.
+ */
+bool _skiplist_lock_valid(node **preds, node **succs, int top_level, node *victim) {
+  node *prev = NULL;
+  node *pred;
+  node *succ;
+  bool valid = true;
+  for (int level = 0; valid && level <= top_level; level++) {
+    pred = preds[level];
+    succ = succs[level];
+    if (pred != prev) {
+      pthread_mutex_lock(&pred->lock);
+      prev = pred;
+    }
+    valid = !atomic_load(&pred->marked)
+      && (succ == NULL || succ == victim || !atomic_load(&succ->marked))
+      && atomic_load(&pred->next[level]) == succ;
+    if (!valid) {
+      _skiplist_unlock(preds, level);
+    }
+  }
+  return valid;
+}
+
+void _skiplist_set(skiplist_conn_t *SC, addr_t k, addr_t v) {
+  node *preds[SKIPLIST_MAX_LEVEL];
+  node *succs[SKIPLIST_MAX_LEVEL];
+  int top_level = _skiplist_random_level(SC);
+  int found;
+  node *N;
+  while (true) {
+    found = _skiplist_find(SC, k, preds, succs);
+    if (found != -1) {
+      N = succs[found];
+      // Wait for the writer linking N to finish.
+      while (!atomic_load(&N->fully_linked)) {
+      }
+      pthread_mutex_lock(&N->lock);
+      if (!atomic_load(&N->marked)) {
+        atomic_store(&N->value, v);
+        pthread_mutex_unlock(&N->lock);
+        return;
+      }
+      // N is being removed, so try again once it is gone.
+      pthread_mutex_unlock(&N->lock);
+      continue;
+    }
+
+    if (!_skiplist_lock_valid(preds, succs, top_level, NULL)) {
+      continue;
+    }
+
+    N = _skiplist_node_create(k, v, top_level);
+    for (int level = 0; level <= top_level; level++) {
+      atomic_init(&N->next[level], succs[level]);
+    }
+    for (int level = 0; level <= top_level; level++) {
+      atomic_store(&preds[level]->next[level], N);
+    }
+    atomic_store(&N->fully_linked, true);
+    atomic_fetch_add(&SC->len, 1);
+    _skiplist_unlock(preds, top_level);
+    return;
+  }
+}
+
+void skiplist_conn_set(skiplist_conn_t *SC, addr_t k, addr_t v) {
+  assert(SC);
+
+  uint64_t e = _skiplist_pin(SC);
+  _skiplist_set(SC, k, v);
+  _skiplist_unpin(SC, e);
+}
+
+addr_t _skiplist_del(skiplist_conn_t *SC, addr_t k) {
+  node *preds[SKIPLIST_MAX_LEVEL];
+  node *succs[SKIPLIST_MAX_LEVEL];
+  node *victim = NULL;
+  int found;
+  while (true) {
+    found = _skiplist_find(SC, k, preds, succs);
+    if (victim == NULL) {
+      // Only remove a node found at its top level,
+      // since otherwise it is still being linked.
+      if (found == -1 || atomic_load(&succs[found]->marked)) {
+        return NULL;
+      }
+      if (!atomic_load(&succs[found]->fully_linked) || succs[found]->top_level != found) {
+        continue;
+      }
+      victim = succs[found];
+      pthread_mutex_lock(&victim->lock);
+      if (atomic_load(&victim->marked)) {
+        pthread_mutex_unlock(&victim->lock);
+        return NULL;
+      }
+      atomic_store(&victim->marked, true);
+    }
+
+    for (int level = 0; level <= victim->top_level; level++) {
+      succs[level] = victim;
+    }
+    if (!_skiplist_lock_valid(preds, succs, victim->top_level, victim)) {
+      continue;
+    }
+
+    for (int level = victim->top_level; level >= 0; level--) {
+      atomic_store(&preds[level]->next[level], atomic_load(&victim->next[level]));
+    }
+    atomic_fetch_sub(&SC->len, 1);
+    pthread_mutex_unlock(&victim->lock);
+    _skiplist_unlock(preds, victim->top_level);
+
+    addr_t v = atomic_load(&victim->value);
+    _skiplist_retire(SC, victim);
+    return v;
+  }
+}
+
+addr_t skiplist_conn_del(skiplist_conn_t *SC, addr_t k) {
+  assert(SC);
+
+  uint64_t e = _skiplist_pin(SC);
+  addr_t v = _skiplist_del(SC, k);
+  _skiplist_unpin(SC, e);
+  return v;
+}
+
+void skiplist_conn_iter_init(skiplist_conn_iter_t *It, skiplist_conn_t *SC) {
+  assert(It);
+  assert(SC);
+
+  It->SC = SC;
+  It->epoch = _skiplist_pin(SC);
+  It->node = SC->head;
+  It->hi = NULL;
+  It->key = NULL;
+  It->value = NULL;
+}
+
+void skiplist_conn_range_init(skiplist_conn_iter_t *It, skiplist_conn_t *SC, addr_t lo, addr_t hi) {
+  skiplist_conn_iter_init(It, SC);
+  It->hi = hi;
+  if (lo == NULL) {
+    return;
+  }
+
+  // Start from the last node before lo.
+  node *pred = SC->head;
+  node *curr;
+  for (int level = SKIPLIST_MAX_LEVEL - 1; level >= 0; level--) {
+    curr = atomic_load(&pred->next[level]);
+    while (curr != NULL && SC->compare(curr->key, lo) > 0) {
+      pred = curr;
+      curr = atomic_load(&pred->next[level]);
+    }
+  }
+  It->node = pred;
+}
+
+bool skiplist_conn_iter_next(skiplist_conn_iter_t *It) {
+  assert(It);
+
+  node *N = It->node;
+  if (N == NULL) {
+    return false;
+  }
+  do {
+    N = atomic_load(&N->next[0]);
+  } while (N != NULL && (atomic_load(&N->marked) || !atomic_load(&N->fully_linked)));
+
+  if (N == NULL || (It->hi != NULL && It->SC->compare(N->key, It->hi) <= 0)) {
+    skiplist_conn_iter_finish(It);
+    return false;
+  }
+  It->node = N;
+  It->key = N->key;
+  It->value = atomic_load(&N->value);
+  return true;
+}
+
+void skiplist_conn_iter_finish(skiplist_conn_iter_t *It) {
+  assert(It);
+
+  if (It->node != NULL) {
+    _skiplist_unpin(It->SC, It->epoch);
+    It->node = NULL;
+  }
+}
+
+addr_t skiplist_conn_iter_key(skiplist_conn_iter_t *It) {
+  assert(It);
+  return It->key;
+}
+
+addr_t skiplist_conn_iter_value(skiplist_conn_iter_t *It) {
+  assert(It);
+  return It->value;
+}
@@ -0,0 +1,537 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/dict.h"
+#include "../include/heap.h"
+#include "../include/item.h"
+#include "../include/list.h"
+#include "../include/memory.h"
+#include "../include/set.h"
+#include "../include/str.h"
+#include "../include/snapshot.h"
+
+/* Layout of a snapshot:
+ *
+ *   "DSSN"  version  kind  count
+ *   len bytes   (count times, or count times a key and then a value)
+ *
+ * where version and kind are a byte each, and count and len are
+ * unsigned LEB128 varints.
+ */
+#define SNAPSHOT_BUFFER_SIZE (1 << 16)
+#define SNAPSHOT_MAX_VARINT_SIZE 10
+
+const char SNAPSHOT_MAGIC[4] = {'D', 'S', 'S', 'N'};
+const char SNAPSHOT_VERSION = 1;
+
+const char SNAPSHOT_LIST = 'L';
+const char SNAPSHOT_DICT = 'D';
+const char SNAPSHOT_SET = 'S';
+const char SNAPSHOT_HEAP = 'H';
+
+/* Entries are encoded into entry first, since their length goes before
+ * them, and then copied into B, which is written out whenever it holds
+ * SNAPSHOT_BUFFER_SIZE bytes. Once a write fails, ok stays false and
+ * nothing more is written.
+ */
+struct _snapshot_writer {
+  int fd;
+  str_buf_t *B;
+  str_buf_t *entry;
+  bool ok;
+};
+typedef struct _snapshot_writer writer;
+
+bool _snapshot_write_all(int fd, const char *data, size_t n) {
+  ssize_t num_written;
+  while (n > 0) {
+    num_written = write(fd, data, n);
+    if (num_written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += num_written;
+    n -= num_written;
+  }
+  return true;
+}
+
+void _snapshot_writer_flush(writer *W) {
+  if (W->ok) {
+    str_view_t V = str_buf_view(W->B);
+    W->ok = _snapshot_write_all(W->fd, V.data, V.len);
+  }
+  str_buf_clear(W->B);
+}
+
+void _snapshot_writer_varint(writer *W, uint64_t x) {
+  while (x >= 0x80) {
+    str_buf_append_char(W->B, (char) ((x & 0x7f) | 0x80));
+    x >>= 7;
+  }
+  str_buf_append_char(W->B, (char) x);
+}
+
+void _snapshot_writer_init(writer *W, int fd, char kind, size_t count) {
+  W->fd = fd;
+  W->B = str_buf_create(SNAPSHOT_BUFFER_SIZE + SNAPSHOT_MAX_VARINT_SIZE);
+  W->entry = str_buf_create(0);
+  W->ok = true;
+
+  str_buf_append_n(W->B, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  str_buf_append_char(W->B, SNAPSHOT_VERSION);
+  str_buf_append_char(W->B, kind);
+  _snapshot_writer_varint(W, count);
+}
+
+void _snapshot_writer_entry(writer *W, snapshot_codec_t *codec, addr_t e) {
+  str_buf_clear(W->entry);
+  codec->encode(e, W->entry);
+
+  str_view_t V = str_buf_view(W->entry);
+  _snapshot_writer_varint(W, V.len);
+  str_buf_append_view(W->B, V);
+  if (str_buf_len(W->B) >= SNAPSHOT_BUFFER_SIZE) {
+    _snapshot_writer_flush(W);
+  }
+}
+
+bool _snapshot_writer_finish(writer *W) {
+  _snapshot_writer_flush(W);
+  str_buf_destroy(W->B);
+  str_buf_destroy(W->entry);
+  return W->ok;
+}
+
+/* buf[start..end) holds the bytes read but not yet used.
+ * It is refilled with as many bytes as fit, and only grows
+ * for an entry longer than it, as the bytes of that entry arrive,
+ * so a corrupt length cannot make it larger than the input.
+ * num_unread is how many bytes of a regular file are left to read,
+ * and SIZE_MAX for anything else, such as a pipe.
+ */
+struct _snapshot_reader {
+  int fd;
+  char *buf;
+  size_t capacity;
+  size_t start;
+  size_t end;
+  size_t num_unread;
+};
+typedef struct _snapshot_reader reader;
+
+void _snapshot_reader_init(reader *R, int fd) {
+  R->fd = fd;
+  R->capacity = SNAPSHOT_BUFFER_SIZE;
+  R->buf = (char *) memory_malloc(R->capacity);
+  R->start = 0;
+  R->end = 0;
+
+  R->num_unread = SIZE_MAX;
+  struct stat st;
+  off_t offset;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    offset = lseek(fd, 0, SEEK_CUR);
+    if (offset >= 0 && offset <= st.st_size) {
+      R->num_unread = (size_t) (st.st_size - offset);
+    }
+  }
+}
+
+// Give back the bytes read past the snapshot, if fd can seek.
+void _snapshot_reader_finish(reader *R) {
+  if (R->end > R->start) {
+    lseek(R->fd, -(off_t) (R->end - R->start), SEEK_CUR);
+  }
+  memory_free(R->buf);
+}
+
+// Most entries that a snapshot holds, if it has n more to come.
+// Each entry takes at least entry_size bytes.
+size_t _snapshot_reader_max_entries(reader *R, size_t n, size_t entry_size) {
+  size_t max_entries = SNAPSHOT_BUFFER_SIZE;
+  if (R->num_unread != SIZE_MAX) {
+    max_entries = (R->end - R->start + R->num_unread) / entry_size;
+  }
+  return n < max_entries ? n : max_entries;
+}
+
+// Double the capacity, but not past n, keeping the buffered bytes.
+void _snapshot_reader_grow(reader *R, size_t n) {
+  size_t new_capacity = R->capacity > n / 2 ? n : 2 * R->capacity;
+  char *new_buf = (char *) memory_malloc(new_capacity);
+  memcpy(new_buf, R->buf, R->end);
+  memory_free(R->buf);
+  R->buf = new_buf;
+  R->capacity = new_capacity;
+}
+
+// Make sure that at least n bytes are buffered.
+// If fd ends or fails first, return false.
+bool _snapshot_reader_fill(reader *R, size_t n) {
+  size_t num_buffered = R->end - R->start;
+  if (num_buffered >= n) {
+    return true;
+  }
+  if (n - num_buffered > R->num_unread) {
+    return false;
+  }
+
+  memmove(R->buf, R->buf + R->start, num_buffered);
+  R->start = 0;
+  R->end = num_buffered;
+
+  ssize_t num_read;
+  while (R->end < n) {
+    if (R->end == R->capacity) {
+      _snapshot_reader_grow(R, n);
+    }
+    num_read = read(R->fd, R->buf + R->end, R->capacity - R->end);
+    if (num_read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (num_read <= 0) {
+      return false;
+    }
+    R->end += num_read;
+    if (R->num_unread != SIZE_MAX) {
+      // The file may have grown since it was opened.
+      R->num_unread -= (size_t) num_read < R->num_unread ? (size_t) num_read : R->num_unread;
+    }
+  }
+  return true;
+}
+
+bool _snapshot_reader_varint(reader *R, uint64_t *x) {
+  unsigned char byte;
+  *x = 0;
+  for (int i = 0; i < SNAPSHOT_MAX_VARINT_SIZE; i++) {
+    if (!_snapshot_reader_fill(R, 1)) {
+      return false;
+    }
+    byte = (unsigned char) R->buf[R->start];
+    R->start++;
+    *x |= (uint64_t) (byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Read the header, and return whether it is a snapshot of kind.
+bool _snapshot_reader_header(reader *R, char kind, size_t *count) {
+  size_t n = sizeof(SNAPSHOT_MAGIC);
+  if (!_snapshot_reader_fill(R, n + 2)) {
+    return false;
+  }
+  const char *header = R->buf + R->start;
+  if (memcmp(header, SNAPSHOT_MAGIC, n) != 0 || header[n] != SNAPSHOT_VERSION || header[n + 1] != kind) {
+    return false;
+  }
+  R->start += n + 2;
+
+  uint64_t x;
+  if (!_snapshot_reader_varint(R, &x)) {
+    return false;
+  }
+  *count = (size_t) x;
+  return true;
+}
+
+bool _snapshot_reader_entry(reader *R, snapshot_codec_t *codec, addr_t *e) {
+  uint64_t len;
+  if (!_snapshot_reader_varint(R, &len) || len > SIZE_MAX || !_snapshot_reader_fill(R, (size_t) len)) {
+    return false;
+  }
+  *e = codec->decode(str_view_n(R->buf + R->start, len));
+  R->start += len;
+  return true;
+}
+
+// Set entry i of L, pushing it if L was presized for fewer entries.
+void _snapshot_list_put(list_t *L, size_t i, addr_t e) {
+  if (i < list_len(L)) {
+    list_set(L, i, e);
+  } else {
+    list_push(L, e);
+  }
+}
+
+// Free the first n entries of L after a failed load.
+void _snapshot_destroy_entries(list_t *L, size_t n, snapshot_codec_t *codec) {
+  if (codec->destroy == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < n; i++) {
+    codec->destroy(list_get(L, i));
+  }
+}
+
+bool list_save(int fd, list_t *L, snapshot_codec_t *codec) {
+  assert(L);
+  assert(codec);
+
+  size_t n = list_len(L);
+  writer W;
+  _snapshot_writer_init(&W, fd, SNAPSHOT_LIST, n);
+  for (size_t i = 0; i < n; i++) {
+    _snapshot_writer_entry(&W, codec, list_get(L, i));
+  }
+  return _snapshot_writer_finish(&W);
+}
+
+list_t *list_load(int fd, snapshot_codec_t *codec) {
+  assert(codec);
+
+  reader R;
+  _snapshot_reader_init(&R, fd);
+  size_t n;
+  if (!_snapshot_reader_header(&R, SNAPSHOT_LIST, &n)) {
+    _snapshot_reader_finish(&R);
+    return NULL;
+  }
+
+  list_t *L = list_create(_snapshot_reader_max_entries(&R, n, 1));
+  addr_t e;
+  for (size_t i = 0; i < n; i++) {
+    if (!_snapshot_reader_entry(&R, codec, &e)) {
+      _snapshot_destroy_entries(L, i, codec);
+      list_destroy(L);
+      _snapshot_reader_finish(&R);
+      return NULL;
+    }
+    _snapshot_list_put(L, i, e);
+  }
+  _snapshot_reader_finish(&R);
+  return L;
+}
+
+bool dict_save(int fd, dict_t *D, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec) {
+  assert(D);
+  assert(key_codec);
+  assert(value_codec);
+
+  writer W;
+  _snapshot_writer_init(&W, fd, SNAPSHOT_DICT, dict_len(D));
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    _snapshot_writer_entry(&W, key_codec, dict_iter_key(&It));
+    _snapshot_writer_entry(&W, value_codec, dict_iter_value(&It));
+  }
+  return _snapshot_writer_finish(&W);
+}
+
+// Free every key and value of D, and D, after a failed load.
+void _snapshot_dict_destroy(dict_t *D, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec) {
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    if (key_codec->destroy != NULL) {
+      key_codec->destroy(dict_iter_key(&It));
+    }
+    if (value_codec->destroy != NULL) {
+      value_codec->destroy(dict_iter_value(&It));
+    }
+  }
+  dict_destroy(D);
+}
+
+// Each item takes at least 2 bytes, the lengths of its key and value.
+dict_t *dict_load(
+  int fd,
+  bool (*key_eq) (addr_t k1, addr_t k2),
+  size_t (*key_hash) (addr_t k),
+  snapshot_codec_t *key_codec,
+  snapshot_codec_t *value_codec
+) {
+  assert(key_codec);
+  assert(value_codec);
+
+  reader R;
+  _snapshot_reader_init(&R, fd);
+  size_t n;
+  if (!_snapshot_reader_header(&R, SNAPSHOT_DICT, &n)) {
+    _snapshot_reader_finish(&R);
+    return NULL;
+  }
+
+  dict_t *D = dict_create(key_eq, key_hash);
+  dict_reserve(D, _snapshot_reader_max_entries(&R, n, 2));
+  addr_t k;
+  addr_t v;
+  addr_t *slot;
+  size_t len;
+  for (size_t i = 0; i < n; i++) {
+    if (!_snapshot_reader_entry(&R, key_codec, &k)) {
+      _snapshot_dict_destroy(D, key_codec, value_codec);
+      _snapshot_reader_finish(&R);
+      return NULL;
+    }
+    if (!_snapshot_reader_entry(&R, value_codec, &v)) {
+      if (key_codec->destroy != NULL) {
+        key_codec->destroy(k);
+      }
+      _snapshot_dict_destroy(D, key_codec, value_codec);
+      _snapshot_reader_finish(&R);
+      return NULL;
+    }
+    len = dict_len(D);
+    slot = dict_get_or_insert(D, k, v);
+    if (dict_len(D) == len) {
+      // k is already in D: keep that key and replace its value.
+      if (key_codec->destroy != NULL) {
+        key_codec->destroy(k);
+      }
+      if (value_codec->destroy != NULL) {
+        value_codec->destroy(*slot);
+      }
+      *slot = v;
+    }
+  }
+  _snapshot_reader_finish(&R);
+  return D;
+}
+
+bool set_save(int fd, set_t *S, snapshot_codec_t *codec) {
+  assert(S);
+  assert(codec);
+
+  writer W;
+  _snapshot_writer_init(&W, fd, SNAPSHOT_SET, set_len(S));
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    _snapshot_writer_entry(&W, codec, set_iter_entry(&It));
+  }
+  return _snapshot_writer_finish(&W);
+}
+
+set_t *set_load(
+  int fd,
+  bool (*entry_eq) (addr_t e1, addr_t e2),
+  size_t (*hash) (addr_t e),
+  snapshot_codec_t *codec
+) {
+  assert(codec);
+
+  reader R;
+  _snapshot_reader_init(&R, fd);
+  size_t n;
+  if (!_snapshot_reader_header(&R, SNAPSHOT_SET, &n)) {
+    _snapshot_reader_finish(&R);
+    return NULL;
+  }
+
+  set_t *S = set_create(entry_eq, hash);
+  set_reserve(S, _snapshot_reader_max_entries(&R, n, 1));
+  addr_t e;
+  set_iter_t It;
+  for (size_t i = 0; i < n; i++) {
+    if (!_snapshot_reader_entry(&R, codec, &e)) {
+      if (codec->destroy != NULL) {
+        set_iter_init(&It, S);
+        while (set_iter_next(&It)) {
+          codec->destroy(set_iter_entry(&It));
+        }
+      }
+      set_destroy(S);
+      _snapshot_reader_finish(&R);
+      return NULL;
+    }
+    if (set_includes(S, e)) {
+      if (codec->destroy != NULL) {
+        codec->destroy(e);
+      }
+    } else {
+      set_add(S, e);
+    }
+  }
+  _snapshot_reader_finish(&R);
+  return S;
+}
+
+bool heap_save(int fd, heap_t *H, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec) {
+  assert(H);
+  assert(key_codec);
+  assert(value_codec);
+
+  list_t *items = heap_items(H);
+  size_t n = list_len(items);
+  writer W;
+  _snapshot_writer_init(&W, fd, SNAPSHOT_HEAP, n);
+  item_t *I;
+  for (size_t i = 0; i < n; i++) {
+    I = (item_t *) list_get(items, i);
+    _snapshot_writer_entry(&W, key_codec, item_get_key(I));
+    _snapshot_writer_entry(&W, value_codec, item_get_value(I));
+  }
+  list_destroy(items);
+  return _snapshot_writer_finish(&W);
+}
+
+// heap_destroy only frees an empty heap, so pop every item first.
+void _snapshot_heap_destroy(heap_t *H, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec) {
+  item_t *I;
+  while (heap_len(H) > 0) {
+    I = heap_peek_min(H);
+    if (key_codec->destroy != NULL) {
+      key_codec->destroy(item_get_key(I));
+    }
+    if (value_codec->destroy != NULL) {
+      value_codec->destroy(item_get_value(I));
+    }
+    heap_delete_min(H);
+  }
+  heap_destroy(H);
+}
+
+// A Fibonacci heap inserts in O(1) without resizing, so there is
+// nothing to presize.
+heap_t *heap_load(
+  int fd,
+  int (*compare)(addr_t k1, addr_t k2),
+  bool (*value_eq) (addr_t v1, addr_t v2),
+  size_t (*value_hash) (addr_t v),
+  snapshot_codec_t *key_codec,
+  snapshot_codec_t *value_codec
+) {
+  assert(key_codec);
+  assert(value_codec);
+
+  reader R;
+  _snapshot_reader_init(&R, fd);
+  size_t n;
+  if (!_snapshot_reader_header(&R, SNAPSHOT_HEAP, &n)) {
+    _snapshot_reader_finish(&R);
+    return NULL;
+  }
+
+  heap_t *H = heap_create(compare, value_eq, value_hash);
+  addr_t k;
+  addr_t v;
+  for (size_t i = 0; i < n; i++) {
+    if (!_snapshot_reader_entry(&R, key_codec, &k)) {
+      _snapshot_heap_destroy(H, key_codec, value_codec);
+      _snapshot_reader_finish(&R);
+      return NULL;
+    }
+    if (!_snapshot_reader_entry(&R, value_codec, &v)) {
+      if (key_codec->destroy != NULL) {
+        key_codec->destroy(k);
+      }
+      _snapshot_heap_destroy(H, key_codec, value_codec);
+      _snapshot_reader_finish(&R);
+      return NULL;
+    }
+    heap_insert(H, k, v);
+  }
+  _snapshot_reader_finish(&R);
+  return H;
+}
@@ -0,0 +1,468 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/item.h"
+#include "../include/list_extended.h"
+#include "../include/str.h"
+#include "../include/snapshot.h"
+
+// Open a new temporary file, which is removed once closed.
+int _temp_file() {
+  char path[] = "/tmp/snapshot.XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  unlink(path);
+  return fd;
+}
+
+void _rewind(int fd) {
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+}
+
+// Append x to buf as an unsigned LEB128 varint, and return its size.
+size_t _varint(char *buf, uint64_t x) {
+  size_t n = 0;
+  while (x >= 0x80) {
+    buf[n++] = (char) ((x & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  buf[n++] = (char) x;
+  return n;
+}
+
+// Write a snapshot header of kind with count entries, and a first
+// entry of len bytes that holds an int, and nothing after it.
+void _write_corrupt_snapshot(int fd, char kind, uint64_t count, uint64_t len) {
+  char buf[32] = {'D', 'S', 'S', 'N', 1, kind};
+  size_t n = 6;
+  n += _varint(buf + n, count);
+  n += _varint(buf + n, len);
+  memset(buf + n, 0, sizeof(int));
+  n += sizeof(int);
+  assert(write(fd, buf, n) == n);
+}
+
+void test_list_snapshot() {
+  printf("list snapshot\n");
+
+  // Enough entries, and one long enough, to span several buffers.
+  int N = 20000;
+  list_t *L = list_create(N);
+  for (int i = 0; i < N; i++) {
+    list_set(L, i, int_wrap(i * 7));
+  }
+  int fd = _temp_file();
+  assert(list_save(fd, L, &INT_CODEC));
+  _rewind(fd);
+  list_t *L2 = list_load(fd, &INT_CODEC);
+  assert(L2);
+  assert(list_len(L2) == N);
+  for (int i = 0; i < N; i++) {
+    assert(int_unwrap(list_get(L2, i)) == i * 7);
+  }
+  list_total_destroy(L, memory_free);
+  list_total_destroy(L2, memory_free);
+  close(fd);
+
+  size_t n = 300000;
+  str_t s = (str_t) memory_malloc(n + 1);
+  for (size_t i = 0; i < n; i++) {
+    s[i] = 'a' + i % 26;
+  }
+  s[n] = '\0';
+  L = list_create(0);
+  list_push(L, str_view_copy(str_view("first")));
+  list_push(L, s);
+  list_push(L, str_view_copy(str_view("")));
+  fd = _temp_file();
+  assert(list_save(fd, L, &STR_CODEC));
+  _rewind(fd);
+  L2 = list_load(fd, &STR_CODEC);
+  assert(L2);
+  assert(list_len(L2) == 3);
+  for (int i = 0; i < 3; i++) {
+    assert(strcmp(list_get(L, i), list_get(L2, i)) == 0);
+  }
+  list_total_destroy(L, memory_free);
+  list_total_destroy(L2, memory_free);
+  close(fd);
+
+  L = list_create(0);
+  fd = _temp_file();
+  assert(list_save(fd, L, &INT_CODEC));
+  _rewind(fd);
+  L2 = list_load(fd, &INT_CODEC);
+  assert(L2);
+  assert(list_len(L2) == 0);
+  list_destroy(L);
+  list_destroy(L2);
+  close(fd);
+}
+
+void test_dict_snapshot() {
+  printf("dict snapshot\n");
+
+  int N = 5000;
+  dict_t *D = dict_create(int_eq, int_hash);
+  addr_t k;
+  for (int i = 0; i < N; i++) {
+    k = int_wrap(i);
+    dict_set(D, k, int_str(k));
+  }
+  int fd = _temp_file();
+  assert(dict_save(fd, D, &INT_CODEC, &STR_CODEC));
+  _rewind(fd);
+  dict_t *D2 = dict_load(fd, int_eq, int_hash, &INT_CODEC, &STR_CODEC);
+  assert(D2);
+  assert(dict_len(D2) == N);
+
+  dict_iter_t It;
+  dict_iter_init(&It, D);
+  while (dict_iter_next(&It)) {
+    assert(strcmp(dict_get(D2, dict_iter_key(&It)), dict_iter_value(&It)) == 0);
+  }
+
+  dict_t *Ds[2] = {D, D2};
+  for (int i = 0; i < 2; i++) {
+    dict_iter_init(&It, Ds[i]);
+    while (dict_iter_next(&It)) {
+      memory_free(dict_iter_key(&It));
+      memory_free(dict_iter_value(&It));
+    }
+    dict_destroy(Ds[i]);
+  }
+  close(fd);
+}
+
+void test_set_snapshot() {
+  printf("set snapshot\n");
+
+  int N = 5000;
+  set_t *S = set_create(int_eq, int_hash);
+  for (int i = 0; i < N; i++) {
+    set_add(S, int_wrap(i * 3));
+  }
+  int fd = _temp_file();
+  assert(set_save(fd, S, &INT_CODEC));
+  _rewind(fd);
+  set_t *S2 = set_load(fd, int_eq, int_hash, &INT_CODEC);
+  assert(S2);
+  assert(set_len(S2) == N);
+
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    assert(set_includes(S2, set_iter_entry(&It)));
+  }
+
+  set_t *Ss[2] = {S, S2};
+  for (int i = 0; i < 2; i++) {
+    set_iter_init(&It, Ss[i]);
+    while (set_iter_next(&It)) {
+      memory_free(set_iter_entry(&It));
+    }
+    set_destroy(Ss[i]);
+  }
+  close(fd);
+}
+
+void _heap_drain(heap_t *H, list_t *keys) {
+  item_t *I;
+  while (heap_len(H) > 0) {
+    I = heap_peek_min(H);
+    if (keys != NULL) {
+      list_push(keys, int_wrap(int_unwrap(item_get_key(I))));
+    }
+    memory_free(item_get_key(I));
+    memory_free(item_get_value(I));
+    heap_delete_min(H);
+  }
+  heap_destroy(H);
+}
+
+void test_heap_snapshot() {
+  printf("heap snapshot\n");
+
+  int N = 500;
+  heap_t *H = heap_create(int_compare, int_eq, int_hash);
+  for (int i = 0; i < N; i++) {
+    // Values need not be unique.
+    heap_insert(H, int_wrap((i * 7919) % N), int_wrap(i % 10));
+  }
+  // Give the heap some shape before saving it.
+  item_t *I = heap_peek_min(H);
+  memory_free(item_get_key(I));
+  memory_free(item_get_value(I));
+  heap_delete_min(H);
+
+  int fd = _temp_file();
+  assert(heap_save(fd, H, &INT_CODEC, &INT_CODEC));
+  _rewind(fd);
+  heap_t *H2 = heap_load(fd, int_compare, int_eq, int_hash, &INT_CODEC, &INT_CODEC);
+  assert(H2);
+  assert(heap_len(H2) == heap_len(H));
+
+  list_t *keys = list_create(0);
+  list_t *keys2 = list_create(0);
+  _heap_drain(H, keys);
+  _heap_drain(H2, keys2);
+  assert(list_len(keys) == N - 1);
+  assert(list_len(keys2) == N - 1);
+  for (int i = 0; i < N - 1; i++) {
+    assert(int_unwrap(list_get(keys, i)) == int_unwrap(list_get(keys2, i)));
+  }
+  list_total_destroy(keys, memory_free);
+  list_total_destroy(keys2, memory_free);
+  close(fd);
+}
+
+void test_snapshot_streams() {
+  printf("snapshot streams\n");
+
+  // Snapshots can follow each other in the same file.
+  list_t *L = list_create(0);
+  set_t *S = set_create(int_eq, int_hash);
+  for (int i = 0; i < 1000; i++) {
+    list_push(L, int_wrap(i));
+    set_add(S, int_wrap(-i));
+  }
+  int fd = _temp_file();
+  assert(list_save(fd, L, &INT_CODEC));
+  assert(set_save(fd, S, &INT_CODEC));
+  _rewind(fd);
+  list_t *L2 = list_load(fd, &INT_CODEC);
+  set_t *S2 = set_load(fd, int_eq, int_hash, &INT_CODEC);
+  assert(L2);
+  assert(S2);
+  assert(list_len(L2) == 1000);
+  assert(set_len(S2) == 1000);
+  assert(int_unwrap(list_get(L2, 999)) == 999);
+  assert(set_includes(S2, list_get(L2, 0)));
+  close(fd);
+
+  // Or go through a pipe.
+  int fds[2];
+  assert(pipe(fds) == 0);
+  list_t *small = list_create(0);
+  for (int i = 0; i < 100; i++) {
+    list_push(small, int_wrap(i));
+  }
+  assert(list_save(fds[1], small, &INT_CODEC));
+  close(fds[1]);
+  list_t *small2 = list_load(fds[0], &INT_CODEC);
+  assert(small2);
+  assert(list_len(small2) == 100);
+  assert(int_unwrap(list_get(small2, 42)) == 42);
+  close(fds[0]);
+
+  list_total_destroy(L, memory_free);
+  list_total_destroy(L2, memory_free);
+  list_total_destroy(small, memory_free);
+  list_total_destroy(small2, memory_free);
+  set_t *Ss[2] = {S, S2};
+  set_iter_t It;
+  for (int i = 0; i < 2; i++) {
+    set_iter_init(&It, Ss[i]);
+    while (set_iter_next(&It)) {
+      memory_free(set_iter_entry(&It));
+    }
+    set_destroy(Ss[i]);
+  }
+}
+
+// Save the ints in arr as a list snapshot, relabelled as a snapshot
+// of kind with count entries, so that it can hold duplicates.
+int _duplicate_snapshot(char kind, uint64_t count, int arr[], size_t len) {
+  list_t *L = list_create(0);
+  for (size_t i = 0; i < len; i++) {
+    list_push(L, int_wrap(arr[i]));
+  }
+  int fd = _temp_file();
+  assert(list_save(fd, L, &INT_CODEC));
+  list_total_destroy(L, memory_free);
+
+  char header[2] = {kind, (char) count};
+  assert(count < 0x80);
+  assert(pwrite(fd, header, 2, 5) == 2);
+  _rewind(fd);
+  return fd;
+}
+
+void test_snapshot_duplicates() {
+  printf("snapshot duplicates\n");
+
+  // The set keeps the first entry, and frees the others.
+  int entries[] = {1, 1, 2, 1};
+  int fd = _duplicate_snapshot('S', 4, entries, 4);
+  set_t *S = set_load(fd, int_eq, int_hash, &INT_CODEC);
+  assert(S);
+  assert(set_len(S) == 2);
+  addr_t e = int_wrap(1);
+  assert(set_includes(S, e));
+  memory_free(e);
+  set_iter_t It;
+  set_iter_init(&It, S);
+  while (set_iter_next(&It)) {
+    memory_free(set_iter_entry(&It));
+  }
+  set_destroy(S);
+  close(fd);
+
+  // The dict keeps the first key with the last value, and frees the others.
+  int items[] = {1, 10, 2, 20, 1, 11, 1, 12};
+  fd = _duplicate_snapshot('D', 4, items, 8);
+  dict_t *D = dict_load(fd, int_eq, int_hash, &INT_CODEC, &INT_CODEC);
+  assert(D);
+  assert(dict_len(D) == 2);
+  addr_t k = int_wrap(1);
+  assert(int_unwrap(dict_get(D, k)) == 12);
+  memory_free(k);
+  k = int_wrap(2);
+  assert(int_unwrap(dict_get(D, k)) == 20);
+  memory_free(k);
+  dict_iter_t Jt;
+  dict_iter_init(&Jt, D);
+  while (dict_iter_next(&Jt)) {
+    memory_free(dict_iter_key(&Jt));
+    memory_free(dict_iter_value(&Jt));
+  }
+  dict_destroy(D);
+  close(fd);
+}
+
+void test_snapshot_errors() {
+  printf("snapshot errors\n");
+
+  list_t *L = list_create(0);
+  for (int i = 0; i < 1000; i++) {
+    list_push(L, int_wrap(i));
+  }
+  assert(!list_save(-1, L, &INT_CODEC));
+
+  // Not the kind of container that was saved.
+  int fd = _temp_file();
+  assert(list_save(fd, L, &INT_CODEC));
+  _rewind(fd);
+  assert(set_load(fd, int_eq, int_hash, &INT_CODEC) == NULL);
+  _rewind(fd);
+  assert(dict_load(fd, int_eq, int_hash, &INT_CODEC, &INT_CODEC) == NULL);
+
+  // Cut short, after some entries were decoded, which are freed.
+  off_t len = lseek(fd, 0, SEEK_END);
+  assert(ftruncate(fd, len / 2) == 0);
+  _rewind(fd);
+  assert(list_load(fd, &INT_CODEC) == NULL);
+  close(fd);
+
+  dict_t *D = dict_create(int_eq, int_hash);
+  heap_t *H = heap_create(int_compare, int_eq, int_hash);
+  for (int i = 0; i < 100; i++) {
+    dict_set(D, list_get(L, i), list_get(L, i));
+    heap_insert(H, list_get(L, i), list_get(L, i));
+  }
+  fd = _temp_file();
+  assert(dict_save(fd, D, &INT_CODEC, &INT_CODEC));
+  len = lseek(fd, 0, SEEK_END);
+  // Cut between a key and its value.
+  assert(ftruncate(fd, len - sizeof(int) - 1) == 0);
+  _rewind(fd);
+  assert(dict_load(fd, int_eq, int_hash, &INT_CODEC, &INT_CODEC) == NULL);
+  close(fd);
+
+  fd = _temp_file();
+  assert(heap_save(fd, H, &INT_CODEC, &INT_CODEC));
+  len = lseek(fd, 0, SEEK_END);
+  assert(ftruncate(fd, len - 1) == 0);
+  _rewind(fd);
+  assert(heap_load(fd, int_compare, int_eq, int_hash, &INT_CODEC, &INT_CODEC) == NULL);
+  close(fd);
+
+  // Not a snapshot.
+  fd = _temp_file();
+  assert(write(fd, "hello world", 11) == 11);
+  _rewind(fd);
+  assert(list_load(fd, &INT_CODEC) == NULL);
+  close(fd);
+
+  fd = _temp_file();
+  assert(list_load(fd, &INT_CODEC) == NULL);
+  close(fd);
+
+  // Counts and lengths far larger than the file, which must not be
+  // allocated for up front.
+  char kinds[] = {'L', 'S', 'D', 'H'};
+  uint64_t counts[] = {1, 1ull << 56, UINT64_MAX};
+  uint64_t lens[] = {sizeof(int), 1ull << 40, 1ull << 63, UINT64_MAX};
+  int fds[2];
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 3; j++) {
+      for (int l = 0; l < 4; l++) {
+        if (j == 0 && l == 0) {
+          continue;
+        }
+        fd = _temp_file();
+        _write_corrupt_snapshot(fd, kinds[i], counts[j], lens[l]);
+        _rewind(fd);
+        switch (kinds[i]) {
+          case 'L':
+            assert(list_load(fd, &INT_CODEC) == NULL);
+            break;
+          case 'S':
+            assert(set_load(fd, int_eq, int_hash, &INT_CODEC) == NULL);
+            break;
+          case 'D':
+            assert(dict_load(fd, int_eq, int_hash, &INT_CODEC, &INT_CODEC) == NULL);
+            break;
+          case 'H':
+            assert(heap_load(fd, int_compare, int_eq, int_hash, &INT_CODEC, &INT_CODEC) == NULL);
+            break;
+        }
+        close(fd);
+      }
+    }
+  }
+  // A pipe has no size to check them against.
+  for (int j = 0; j < 3; j++) {
+    for (int l = 0; l < 4; l++) {
+      if (j == 0 && l == 0) {
+        continue;
+      }
+      assert(pipe(fds) == 0);
+      _write_corrupt_snapshot(fds[1], 'L', counts[j], lens[l]);
+      close(fds[1]);
+      assert(list_load(fds[0], &INT_CODEC) == NULL);
+      close(fds[0]);
+    }
+  }
+
+  while (heap_len(H) > 0) {
+    heap_delete_min(H);
+  }
+  heap_destroy(H);
+  dict_destroy(D);
+  list_total_destroy(L, memory_free);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_list_snapshot();
+  test_dict_snapshot();
+  test_set_snapshot();
+  test_heap_snapshot();
+  test_snapshot_streams();
+  test_snapshot_duplicates();
+  test_snapshot_errors();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
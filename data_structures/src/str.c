@@ -1,10 +1,203 @@
+#define _GNU_SOURCE
 #include <assert.h>
-#include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+
+#if defined(__OPTIMIZE__) && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#endif
 
 #include "../include/str.h"
 #include "../include/memory.h"
 
+/* Byte scanning kernels, which compare a whole vector of bytes at
+ * once and turn the result into a bit mask, one bit per byte.
+ * Without SSE2 or AVX2 they fall back to the C library or a loop over
+ * bytes. So do unoptimized builds, where every intrinsic goes through
+ * memory and the kernels run several times slower than the fallbacks.
+ */
+#if !defined(__OPTIMIZE__)
+#define STR_VECTOR_BYTES 0
+#elif defined(__AVX2__)
+#define STR_VECTOR_BYTES 32
+#define STR_VECTOR_MASK 0xffffffffu
+typedef __m256i _str_vector;
+#define _str_load(p) _mm256_loadu_si256((const __m256i *) (p))
+#define _str_splat(c) _mm256_set1_epi8(c)
+#define _str_eq(a, b) _mm256_cmpeq_epi8(a, b)
+#define _str_or(a, b) _mm256_or_si256(a, b)
+#define _str_and(a, b) _mm256_and_si256(a, b)
+#define _str_sub(a, b) _mm256_sub_epi8(a, b)
+#define _str_min(a, b) _mm256_min_epu8(a, b)
+#define _str_mask(v) ((uint32_t) _mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#define STR_VECTOR_BYTES 16
+#define STR_VECTOR_MASK 0xffffu
+typedef __m128i _str_vector;
+#define _str_load(p) _mm_loadu_si128((const __m128i *) (p))
+#define _str_splat(c) _mm_set1_epi8(c)
+#define _str_eq(a, b) _mm_cmpeq_epi8(a, b)
+#define _str_or(a, b) _mm_or_si128(a, b)
+#define _str_and(a, b) _mm_and_si128(a, b)
+#define _str_sub(a, b) _mm_sub_epi8(a, b)
+#define _str_min(a, b) _mm_min_epu8(a, b)
+#define _str_mask(v) ((uint32_t) _mm_movemask_epi8(v))
+#else
+#define STR_VECTOR_BYTES 0
+#endif
+
+// Same as isspace in the C locale: ' ', and '\t' through '\r'.
+bool _str_is_space(char c) {
+  return c == ' ' || (unsigned char) (c - '\t') <= '\r' - '\t';
+}
+
+#if STR_VECTOR_BYTES > 0
+uint32_t _str_space_mask(_str_vector v) {
+  _str_vector offset = _str_sub(v, _str_splat('\t'));
+  _str_vector is_control = _str_eq(_str_min(offset, _str_splat('\r' - '\t')), offset);
+  return _str_mask(_str_or(_str_eq(v, _str_splat(' ')), is_control));
+}
+#endif
+
+/* Return the index of the first c in s[0..n), or n.
+ * Without the kernels, memchr is already vectorized by the C library,
+ * and unlike strchr it stops at n rather than at a \0.
+ */
+size_t _str_find_byte(const char *s, size_t n, char c) {
+#if STR_VECTOR_BYTES > 0
+  size_t i = 0;
+  _str_vector target = _str_splat(c);
+  uint32_t mask;
+  for (; i + STR_VECTOR_BYTES <= n; i += STR_VECTOR_BYTES) {
+    mask = _str_mask(_str_eq(_str_load(s + i), target));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  for (; i < n; i++) {
+    if (s[i] == c) {
+      return i;
+    }
+  }
+  return n;
+#else
+  const char *p = memchr(s, c, n);
+  return p == NULL ? n : (size_t) (p - s);
+#endif
+}
+
+// Delimiters are short, so compare them in place rather than calling memcmp.
+bool _str_matches(const char *s, const char *sub, size_t m) {
+  for (size_t i = 1; i < m; i++) {
+    if (s[i] != sub[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Return the index of the first sub[0..m) in s[0..n), or n.
+ * Candidates are the positions where both the first byte of sub and
+ * the last byte k that differs from it match, and only those are
+ * compared in full. Picking two different bytes keeps delimiters
+ * such as " >> " from matching at every pair of spaces. Without the
+ * kernels, memchr finds the candidates from byte k alone, which beats
+ * memmem, built for long needles, several times over on delimiters.
+ */
+size_t _str_find(const char *s, size_t n, const char *sub, size_t m) {
+  if (m == 0) {
+    return 0;
+  }
+  if (m == 1) {
+    return _str_find_byte(s, n, sub[0]);
+  }
+  if (m > n) {
+    return n;
+  }
+
+  size_t k = m - 1;
+  while (k > 0 && sub[k] == sub[0]) {
+    k--;
+  }
+#if STR_VECTOR_BYTES > 0
+  _str_vector first = _str_splat(sub[0]);
+  _str_vector other = _str_splat(sub[k]);
+  uint32_t mask;
+  size_t i = 0;
+  size_t j;
+  for (; i + m - 1 + STR_VECTOR_BYTES <= n; i += STR_VECTOR_BYTES) {
+    mask = _str_mask(_str_and(
+      _str_eq(_str_load(s + i), first),
+      _str_eq(_str_load(s + i + k), other)
+    ));
+    while (mask != 0) {
+      j = __builtin_ctz(mask);
+      if (_str_matches(s + i + j, sub, m)) {
+        return i + j;
+      }
+      mask &= mask - 1;
+    }
+  }
+  for (; i + m <= n; i++) {
+    if (s[i] == sub[0] && _str_matches(s + i, sub, m)) {
+      return i;
+    }
+  }
+#else
+  const char *end = s + n - (m - 1 - k);
+  const char *p = s + k;
+  while ((p = memchr(p, sub[k], end - p)) != NULL) {
+    if (memcmp(p - k, sub, m) == 0) {
+      return p - k - s;
+    }
+    p++;
+  }
+#endif
+  return n;
+}
+
+// Return the index of the first non-space in s[0..n), or n.
+size_t _str_skip_space(const char *s, size_t n) {
+  size_t i = 0;
+#if STR_VECTOR_BYTES > 0
+  uint32_t mask;
+  for (; i + STR_VECTOR_BYTES <= n; i += STR_VECTOR_BYTES) {
+    mask = ~_str_space_mask(_str_load(s + i)) & STR_VECTOR_MASK;
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    if (!_str_is_space(s[i])) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// Return one past the index of the last non-space in s[0..n), or 0.
+size_t _str_skip_space_back(const char *s, size_t n) {
+  size_t end = n;
+#if STR_VECTOR_BYTES > 0
+  uint32_t mask;
+  for (; end >= STR_VECTOR_BYTES; end -= STR_VECTOR_BYTES) {
+    mask = ~_str_space_mask(_str_load(s + end - STR_VECTOR_BYTES)) & STR_VECTOR_MASK;
+    if (mask != 0) {
+      return end - STR_VECTOR_BYTES + (31 - __builtin_clz(mask)) + 1;
+    }
+  }
+#endif
+  for (; end > 0; end--) {
+    if (!_str_is_space(s[end - 1])) {
+      return end;
+    }
+  }
+  return 0;
+}
+
 addr_t str_wrap(str_t s) {
   addr_t e = memory_malloc(sizeof(str_t));
   *((str_t *) e) = s;
@@ -29,109 +222,343 @@ str_t str_splice(str_t s, size_t start, size_t end) {
 str_t str_join(list_t *L, str_t delimiter) {
   assert(L);
 
-  str_t token;
-
-  size_t total_len = 0;
+  size_t dn = strlen(delimiter);
+  str_buf_t *B = str_buf_create(0);
   for (int i = 0; i < list_len(L); i++) {
     if (i > 0) {
-      total_len += strlen(delimiter);
+      str_buf_append_n(B, delimiter, dn);
     }
-    token = str_unwrap(list_get(L, i));
-    total_len += strlen(token);
+    str_buf_append(B, str_unwrap(list_get(L, i)));
   }
+  return str_buf_finish(B);
+}
 
-  str_t acc = (str_t) memory_calloc(total_len + 1, sizeof(char));
-  for (int i = 0; i < list_len(L); i++) {
-    if (i > 0) {
-      acc = strncat(acc, delimiter, strlen(delimiter));
+list_t *str_split(str_t s, str_t delimiter) {
+  assert(s);
+
+  list_t *L = list_create(0);
+
+  str_split_iter_t It;
+  str_split_iter_init(&It, str_view(s), str_view(delimiter));
+  while (str_split_iter_next(&It)) {
+    list_push(L, str_wrap(str_view_copy(str_split_iter_token(&It))));
+  }
+  return L;
+}
+
+list_t *str_splitlines(str_t s) {
+  assert(s);
+
+  return str_split(s, "\n");
+}
+
+// Append the tokens of V split on sub1 to R, joined with sub2,
+// as str_join would.
+void _str_replace_into(str_buf_t *R, str_view_t V, str_view_t sub1, str_view_t sub2) {
+  bool first = true;
+  str_split_iter_t It;
+  str_split_iter_init(&It, V, sub1);
+  while (str_split_iter_next(&It)) {
+    if (!first) {
+      str_buf_append_view(R, sub2);
     }
-    token = str_unwrap(list_get(L, i));
-    acc = strncat(acc, token, strlen(token));
+    str_buf_append_view(R, str_split_iter_token(&It));
+    first = false;
   }
+}
+
+str_t str_replace(str_t s, str_t sub1, str_t sub2) {
+  assert(s);
 
-  return acc;
+  str_view_t V = str_view(s);
+  str_buf_t *R = str_buf_create(V.len);
+  _str_replace_into(R, V, str_view(sub1), str_view(sub2));
+  return str_buf_finish(R);
 }
 
-list_t *str_split(str_t s, str_t delimiter) {
+str_t str_strip(str_t s) {
   assert(s);
 
-  size_t n = strlen(s);
-  size_t dn = strlen(delimiter);
+  return str_view_copy(str_view_strip(str_view(s)));
+}
 
-  list_t *L = list_create(0);
+struct _impl_str_buf_t {
+  size_t len;
+  // Not counting the \0, which always follows the last char.
+  size_t capacity;
+  str_t data;
+};
 
-  // edge-case: return string when encounter "" delimiter
-  // unless string is "", in which case return empty list
-  if (dn == 0) {
-    if (n > 0) {
-      str_t c = (str_t) memory_calloc(n, sizeof(char));
-      strlcpy(c, s, n+1); // +1 for \0
-      list_push(L, str_wrap(c));
-    }
-    return L;
-  }
-
-  addr_t token;
-  char *prev = s;
-  char *curr = s;
-  size_t prev_index = 0;
-  size_t curr_index = 0;
-  while (curr_index < n) {
-    curr = strstr(prev, delimiter);
-    if (curr == NULL) {
-      curr_index = n;
-    } else {
-      curr_index = (curr - prev) + prev_index;
-    }
+str_buf_t *str_buf_create(size_t capacity) {
+  str_buf_t *B = (str_buf_t *) memory_malloc(sizeof(str_buf_t));
 
-    token = str_wrap(str_splice(s, prev_index, curr_index));
-    list_push(L, token);
+  B->len = 0;
+  B->capacity = capacity;
+  B->data = (str_t) memory_malloc(capacity + 1);
+  B->data[0] = '\0';
 
-    prev_index = curr_index + dn;
-    prev = curr + dn;
+  return B;
+}
+
+void str_buf_destroy(str_buf_t *B) {
+  assert(B);
+
+  memory_free(B->data);
+  memory_free(B);
+}
+
+size_t str_buf_len(str_buf_t *B) {
+  assert(B);
+  return B->len;
+}
+
+// Make room for at least n more chars, at least doubling the capacity.
+void _str_buf_reserve(str_buf_t *B, size_t n) {
+  if (B->len + n <= B->capacity) {
+    return;
   }
 
-  return L;
+  size_t capacity = 2 * B->capacity;
+  if (capacity < B->len + n) {
+    capacity = B->len + n;
+  }
+  if (capacity < 16) {
+    capacity = 16;
+  }
+  str_t data = (str_t) memory_malloc(capacity + 1);
+  memcpy(data, B->data, B->len + 1);
+  memory_free(B->data);
+  B->data = data;
+  B->capacity = capacity;
 }
 
-list_t *str_splitlines(str_t s) {
-  assert(s);
+void str_buf_append_n(str_buf_t *B, const char *s, size_t n) {
+  assert(B);
 
-  return str_split(s, "\n");
+  _str_buf_reserve(B, n);
+  memcpy(B->data + B->len, s, n);
+  B->len += n;
+  B->data[B->len] = '\0';
 }
 
-str_t str_replace(str_t s, str_t sub1, str_t sub2) {
+void str_buf_append(str_buf_t *B, str_t s) {
   assert(s);
+  str_buf_append_n(B, s, strlen(s));
+}
 
-  list_t *L = str_split(s, sub1);
-  str_t ns = str_join(L, sub2);
+void str_buf_append_char(str_buf_t *B, char c) {
+  assert(B);
 
-  addr_t e;
-  str_t t;
-  for (int i = 0; i < list_len(L); i++) {
-    e = list_get(L, i);
-    t = str_unwrap(e);
-    memory_free(t);
-    memory_free(e);
+  _str_buf_reserve(B, 1);
+  B->data[B->len] = c;
+  B->len++;
+  B->data[B->len] = '\0';
+}
+
+void str_buf_append_owned(str_buf_t *B, str_t s) {
+  str_buf_append(B, s);
+  memory_free(s);
+}
+
+void str_buf_appendf(str_buf_t *B, const char *format, ...) {
+  assert(B);
+
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(B->data + B->len, B->capacity - B->len + 1, format, args);
+  va_end(args);
+  assert(n >= 0);
+
+  // Only format a second time if the first attempt did not fit.
+  if (B->len + n > B->capacity) {
+    _str_buf_reserve(B, n);
+    va_start(args, format);
+    vsnprintf(B->data + B->len, n + 1, format, args);
+    va_end(args);
   }
-  list_destroy(L);
+  B->len += n;
+}
+
+str_t str_buf_finish(str_buf_t *B) {
+  assert(B);
 
-  return ns;
+  str_t s = B->data;
+  memory_free(B);
+  return s;
 }
 
-str_t str_strip(str_t s) {
+str_view_t str_view(str_t s) {
   assert(s);
+  return str_view_n(s, strlen(s));
+}
+
+str_view_t str_view_n(const char *s, size_t n) {
+  str_view_t V = {s, n};
+  return V;
+}
+
+str_t str_view_copy(str_view_t V) {
+  str_t s = (str_t) memory_malloc(V.len + 1);
+  memcpy(s, V.data, V.len);
+  s[V.len] = '\0';
+  return s;
+}
+
+bool str_view_eq(str_view_t V1, str_view_t V2) {
+  return V1.len == V2.len && memcmp(V1.data, V2.data, V1.len) == 0;
+}
 
-  size_t n = strlen(s);
-  size_t start = 0;
-  while (isspace(s[start])) {
-    start++;
+str_view_t str_view_splice(str_view_t V, size_t start, size_t end) {
+  assert(start <= end && end <= V.len);
+  return str_view_n(V.data + start, end - start);
+}
+
+str_view_t str_view_strip(str_view_t V) {
+  size_t start = _str_skip_space(V.data, V.len);
+  size_t end = start + _str_skip_space_back(V.data + start, V.len - start);
+  return str_view_splice(V, start, end);
+}
+
+size_t str_view_find(str_view_t V, str_view_t sub) {
+  return _str_find(V.data, V.len, sub.data, sub.len);
+}
+
+void str_split_iter_init(str_split_iter_t *It, str_view_t s, str_view_t delimiter) {
+  assert(It);
+
+  It->s = s;
+  It->delimiter = delimiter;
+  It->index = 0;
+  It->token = str_view_n(s.data, 0);
+}
+
+void str_splitlines_iter_init(str_split_iter_t *It, str_view_t s) {
+  str_split_iter_init(It, s, str_view_n("\n", 1));
+}
+
+/* As with str_split, a delimiter at the very end does not start
+ * another token, and an empty delimiter gives the whole string.
+ */
+bool str_split_iter_next(str_split_iter_t *It) {
+  assert(It);
+
+  if (It->index >= It->s.len) {
+    return false;
   }
+
+  // Called once per token, so skip the checks of str_view_splice.
+  const char *rest = It->s.data + It->index;
+  size_t n = It->s.len - It->index;
   size_t end = n;
-  while (end > start && isspace(s[end-1])) {
-    end--;
+  if (It->delimiter.len > 0) {
+    end = _str_find(rest, n, It->delimiter.data, It->delimiter.len);
   }
+  It->token.data = rest;
+  It->token.len = end;
+  It->index += end + It->delimiter.len;
+  return true;
+}
+
+str_view_t str_split_iter_token(str_split_iter_t *It) {
+  assert(It);
+  return It->token;
+}
+
+str_buf_t *str_buf_from_str(str_t s) {
+  assert(s);
+  return str_buf_from_view(str_view(s));
+}
+
+str_buf_t *str_buf_from_view(str_view_t V) {
+  str_buf_t *B = str_buf_create(V.len);
+  str_buf_append_n(B, V.data, V.len);
+  return B;
+}
+
+size_t str_buf_capacity(str_buf_t *B) {
+  assert(B);
+  return B->capacity;
+}
+
+str_t str_buf_str(str_buf_t *B) {
+  assert(B);
+  return B->data;
+}
+
+str_view_t str_buf_view(str_buf_t *B) {
+  assert(B);
+  return str_view_n(B->data, B->len);
+}
+
+void str_buf_append_view(str_buf_t *B, str_view_t V) {
+  str_buf_append_n(B, V.data, V.len);
+}
+
+void str_buf_clear(str_buf_t *B) {
+  str_buf_truncate(B, 0);
+}
+
+void str_buf_truncate(str_buf_t *B, size_t len) {
+  assert(B);
+  assert(len <= B->len);
+
+  B->len = len;
+  B->data[len] = '\0';
+}
+
+str_buf_t *str_buf_splice(str_buf_t *B, size_t start, size_t end) {
+  assert(B);
+  return str_buf_from_view(str_view_splice(str_buf_view(B), start, end));
+}
+
+str_buf_t *str_buf_join(list_t *L, str_view_t delimiter) {
+  assert(L);
+
+  size_t n = list_len(L);
+  size_t total_len = 0;
+  for (int i = 0; i < n; i++) {
+    total_len += str_buf_len((str_buf_t *) list_get(L, i));
+  }
+  if (n > 1) {
+    total_len += (n - 1) * delimiter.len;
+  }
+
+  str_buf_t *J = str_buf_create(total_len);
+  for (int i = 0; i < n; i++) {
+    if (i > 0) {
+      str_buf_append_view(J, delimiter);
+    }
+    str_buf_append_view(J, str_buf_view((str_buf_t *) list_get(L, i)));
+  }
+  return J;
+}
+
+list_t *str_buf_split(str_buf_t *B, str_view_t delimiter) {
+  assert(B);
+
+  list_t *L = list_create(0);
+
+  str_split_iter_t It;
+  str_split_iter_init(&It, str_buf_view(B), delimiter);
+  while (str_split_iter_next(&It)) {
+    list_push(L, str_buf_from_view(str_split_iter_token(&It)));
+  }
+  return L;
+}
+
+list_t *str_buf_splitlines(str_buf_t *B) {
+  return str_buf_split(B, str_view_n("\n", 1));
+}
+
+str_buf_t *str_buf_replace(str_buf_t *B, str_view_t sub1, str_view_t sub2) {
+  assert(B);
+
+  str_buf_t *R = str_buf_create(B->len);
+  _str_replace_into(R, str_buf_view(B), sub1, sub2);
+  return R;
+}
 
-  str_t stripped = str_splice(s, start, end);
-  return stripped;
+str_buf_t *str_buf_strip(str_buf_t *B) {
+  assert(B);
+  return str_buf_from_view(str_view_strip(str_buf_view(B)));
 }
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <ctype.h>
 #include <stdio.h>
 
 #include "../include/test_utils.h"
@@ -261,6 +262,212 @@ void test_str_strip() {
   memory_free(actual);
 }
 
+void test_str_buf() {
+  printf("str buf\n");
+
+  str_buf_t *B = str_buf_create(0);
+  assert(str_buf_len(B) == 0);
+  str_t actual = str_buf_finish(B);
+  assert(strcmp(actual, "") == 0);
+  memory_free(actual);
+
+  B = str_buf_create(4);
+  str_buf_append(B, "Hello");
+  str_buf_append_char(B, ',');
+  str_buf_append_n(B, " World!!!", 7);
+  assert(str_buf_len(B) == 13);
+  str_buf_appendf(B, " %d + %s = %lu", 1, "one", (size_t) 2);
+  addr_t e = int_wrap(3);
+  str_buf_append_owned(B, int_str(e));
+  memory_free(e);
+  assert(str_buf_len(B) == 26);
+  actual = str_buf_finish(B);
+  assert(strcmp(actual, "Hello, World! 1 + one = 23") == 0);
+  memory_free(actual);
+
+  // Grow many times over.
+  B = str_buf_create(0);
+  for (int i = 0; i < 1000; i++) {
+    str_buf_appendf(B, "%03d", i);
+  }
+  assert(str_buf_len(B) == 3000);
+  actual = str_buf_finish(B);
+  assert(strncmp(actual, "000001002", 9) == 0);
+  assert(strcmp(actual + 2997, "999") == 0);
+  memory_free(actual);
+
+  B = str_buf_create(8);
+  str_buf_append(B, "discarded");
+  str_buf_destroy(B);
+}
+
+void test_str_view() {
+  printf("str view\n");
+
+  str_t s = "  key = value\t\n";
+  str_view_t V = str_view(s);
+  assert(V.data == s && V.len == strlen(s));
+
+  str_view_t stripped = str_view_strip(V);
+  assert(stripped.data == s + 2);
+  assert(str_view_eq(stripped, str_view("key = value")));
+  assert(str_view_strip(str_view(" \n ")).len == 0);
+
+  assert(str_view_find(stripped, str_view(" = ")) == 3);
+  assert(str_view_find(stripped, str_view("value")) == 6);
+  assert(str_view_find(stripped, str_view("values")) == stripped.len);
+  assert(str_view_find(stripped, str_view("y = v")) == 2);
+  assert(str_view_find(stripped, str_view("")) == 0);
+
+  str_view_t key = str_view_splice(stripped, 0, 3);
+  str_t copy = str_view_copy(key);
+  assert(strcmp(copy, "key") == 0);
+  memory_free(copy);
+}
+
+void test_str_split_iter() {
+  printf("str split iter\n");
+
+  str_t cases[][3] = {
+    {"apples >> bananas >> oranges >> grapes", " >> ", "apples|bananas|oranges|grapes|"},
+    {"apples|bananas", " >> ", "apples|bananas|"},
+    {"apples|bananas", "", "apples|bananas|"},
+    {"", " ", ""},
+    {"", "", ""},
+    {",a,,b,", ",", "|a||b|"},
+  };
+
+  str_split_iter_t It;
+  str_view_t token;
+  str_buf_t *B;
+  str_t actual;
+  size_t num_cases = sizeof(cases) / sizeof(cases[0]);
+  for (int i = 0; i < num_cases; i++) {
+    B = str_buf_create(0);
+    str_split_iter_init(&It, str_view(cases[i][0]), str_view(cases[i][1]));
+    while (str_split_iter_next(&It)) {
+      token = str_split_iter_token(&It);
+      // Tokens point into the original string.
+      assert(token.data >= cases[i][0] && token.data + token.len <= cases[i][0] + strlen(cases[i][0]));
+      str_buf_append_n(B, token.data, token.len);
+      str_buf_append_char(B, '|');
+    }
+    actual = str_buf_finish(B);
+    assert(strcmp(actual, cases[i][2]) == 0);
+    memory_free(actual);
+  }
+
+  size_t num_lines = 0;
+  str_splitlines_iter_init(&It, str_view("one\ntwo\n\nfour\n"));
+  while (str_split_iter_next(&It)) {
+    num_lines++;
+  }
+  assert(num_lines == 4);
+}
+
+// Check the vectorized scans against a byte-at-a-time reference,
+// on random strings long enough to cross several vector widths.
+void test_str_scan_kernels() {
+  printf("str scan kernels\n");
+
+  char alphabet[] = "ab \t\n";
+  char buf[200];
+  char sub[5];
+  size_t n;
+  size_t m;
+  size_t expected;
+  size_t start;
+  size_t end;
+  str_view_t V;
+  unsigned int seed = 1;
+  for (int round = 0; round < 20000; round++) {
+    seed = seed * 1103515245 + 12345;
+    n = (seed >> 8) % sizeof(buf);
+    m = 1 + (seed >> 20) % 4;
+    for (int i = 0; i < n; i++) {
+      seed = seed * 1103515245 + 12345;
+      // Mostly spaces in odd rounds, so that strips and finds go far.
+      if (round % 2 == 1 && (seed >> 16) % 13 < 8) {
+        buf[i] = ' ';
+      } else {
+        buf[i] = alphabet[(seed >> 16) % 5];
+      }
+    }
+    for (int i = 0; i < m; i++) {
+      seed = seed * 1103515245 + 12345;
+      sub[i] = alphabet[(seed >> 16) % 3];
+    }
+    V = str_view_n(buf, n);
+
+    expected = n;
+    for (size_t i = 0; i + m <= n; i++) {
+      if (memcmp(buf + i, sub, m) == 0) {
+        expected = i;
+        break;
+      }
+    }
+    assert(str_view_find(V, str_view_n(sub, m)) == expected);
+
+    start = 0;
+    while (start < n && isspace(buf[start])) {
+      start++;
+    }
+    end = n;
+    while (end > start && isspace(buf[end - 1])) {
+      end--;
+    }
+    V = str_view_strip(V);
+    assert(V.data == buf + start && V.len == end - start);
+  }
+}
+
+void _str_buf_entry_destroy(addr_t e) {
+  str_buf_destroy((str_buf_t *) e);
+}
+
+void test_str_buf_ops() {
+  printf("str buf ops\n");
+
+  str_buf_t *B = str_buf_from_str("  apples >> bananas >> grapes \n");
+  assert(str_buf_len(B) == 31);
+  assert(str_buf_capacity(B) >= 31);
+  assert(strcmp(str_buf_str(B), "  apples >> bananas >> grapes \n") == 0);
+
+  str_buf_t *S = str_buf_strip(B);
+  assert(strcmp(str_buf_str(S), "apples >> bananas >> grapes") == 0);
+
+  str_buf_t *P = str_buf_splice(S, 10, 17);
+  assert(strcmp(str_buf_str(P), "bananas") == 0);
+  assert(str_view_eq(str_buf_view(P), str_view("bananas")));
+
+  list_t *L = str_buf_split(S, str_view(" >> "));
+  assert(list_len(L) == 3);
+  assert(strcmp(str_buf_str((str_buf_t *) list_get(L, 1)), "bananas") == 0);
+
+  str_buf_t *J = str_buf_join(L, str_view("|"));
+  assert(strcmp(str_buf_str(J), "apples|bananas|grapes") == 0);
+  assert(str_buf_len(J) == 21);
+
+  str_buf_t *R = str_buf_replace(S, str_view(" >> "), str_view(", "));
+  assert(strcmp(str_buf_str(R), "apples, bananas, grapes") == 0);
+
+  list_t *lines = str_buf_splitlines(B);
+  assert(list_len(lines) == 1);
+
+  str_buf_clear(J);
+  assert(str_buf_len(J) == 0 && strcmp(str_buf_str(J), "") == 0);
+  str_buf_append_view(J, str_view_n("abc", 2));
+  assert(strcmp(str_buf_str(J), "ab") == 0);
+
+  list_total_destroy(lines, _str_buf_entry_destroy);
+  list_total_destroy(L, _str_buf_entry_destroy);
+  str_buf_destroy(B);
+  str_buf_destroy(S);
+  str_buf_destroy(P);
+  str_buf_destroy(J);
+  str_buf_destroy(R);
+}
+
 int main() {
   memory_pointers_init();
 
@@ -270,6 +477,11 @@ int main() {
   test_str_splitlines();
   test_str_replace();
   test_str_strip();
+  test_str_buf();
+  test_str_view();
+  test_str_split_iter();
+  test_str_scan_kernels();
+  test_str_buf_ops();
 
   str_t usage = memory_pointers_report();
   str_t expected = "->";
@@ -0,0 +1,111 @@
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/str.h"
+
+double _mb_per_sec(size_t n, clock_t start, clock_t end) {
+  return ((double) n / (1 << 20)) / (((double) (end - start)) / CLOCKS_PER_SEC);
+}
+
+// Count the tokens of s split on delimiter by calling strstr
+// from the previous position, as str_split used to.
+size_t _strstr_count(str_t s, size_t n, str_t delimiter) {
+  size_t dn = strlen(delimiter);
+  size_t num_tokens = 0;
+  char *prev = s;
+  char *curr;
+  while (prev < s + n) {
+    curr = strstr(prev, delimiter);
+    num_tokens++;
+    if (curr == NULL) {
+      break;
+    }
+    prev = curr + dn;
+  }
+  return num_tokens;
+}
+
+size_t _split_iter_count(str_t s, size_t n, str_t delimiter) {
+  size_t num_tokens = 0;
+  str_split_iter_t It;
+  str_split_iter_init(&It, str_view_n(s, n), str_view(delimiter));
+  while (str_split_iter_next(&It)) {
+    num_tokens++;
+  }
+  return num_tokens;
+}
+
+// Scan N bytes of log-like lines for newlines and for a multi-byte
+// delimiter, and strip every line, reporting throughput in MB/s.
+void test_str_scan_performance() {
+  int MAG = 3;
+  str_t s;
+  size_t num_tokens;
+  size_t expected;
+  str_split_iter_t It;
+  str_view_t line;
+  size_t stripped_len;
+  clock_t start;
+  clock_t end;
+
+  size_t N = 16 << 20;
+
+  for (int i = 0; i < MAG; i++) {
+    s = (str_t) memory_malloc(N + 1);
+    size_t n = 0;
+    int line_num = 0;
+    while (n < N) {
+      n += snprintf(s + n, N + 1 - n, "   request %d >> GET /index.html >> 200 OK in %d ms   \n", line_num, line_num % 997);
+      line_num++;
+    }
+    n = strlen(s);
+
+    printf("# BYTES: %lu\n", n);
+
+    start = clock();
+    expected = _strstr_count(s, n, "\n");
+    end = clock();
+    printf("MB/S (STRSTR NEWLINE): %lf\n", _mb_per_sec(n, start, end));
+
+    start = clock();
+    num_tokens = _split_iter_count(s, n, "\n");
+    end = clock();
+    printf("MB/S (SPLIT NEWLINE): %lf\n", _mb_per_sec(n, start, end));
+    assert(num_tokens == expected);
+
+    start = clock();
+    expected = _strstr_count(s, n, " >> ");
+    end = clock();
+    printf("MB/S (STRSTR DELIMITER): %lf\n", _mb_per_sec(n, start, end));
+
+    start = clock();
+    num_tokens = _split_iter_count(s, n, " >> ");
+    end = clock();
+    printf("MB/S (SPLIT DELIMITER): %lf\n", _mb_per_sec(n, start, end));
+    assert(num_tokens == expected);
+
+    stripped_len = 0;
+    start = clock();
+    str_splitlines_iter_init(&It, str_view_n(s, n));
+    while (str_split_iter_next(&It)) {
+      line = str_view_strip(str_split_iter_token(&It));
+      stripped_len += line.len;
+    }
+    end = clock();
+    printf("MB/S (SPLITLINES + STRIP): %lf\n", _mb_per_sec(n, start, end));
+    assert(stripped_len < n);
+
+    memory_free(s);
+
+    N *= 2;
+  }
+}
+
+int main() {
+  test_str_scan_performance();
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+#include <assert.h>
+
+#include "../include/memory.h"
+#include "../include/str.h"
+#include "../include/str_stream.h"
+
+/* The carry holds the input since the end of the last token that was
+ * not yet part of a token, i.e. the start of a token that spans
+ * chunks, possibly followed by the start of a delimiter.
+ * It never holds a whole delimiter.
+ */
+struct _impl_str_stream_t {
+  str_t delimiter;
+  size_t delimiter_len;
+  str_buf_t *carry;
+  // The carry was handed out as the current token, so clear it first.
+  bool carry_emitted;
+  str_view_t chunk;
+  size_t index;
+  bool finished;
+  str_view_t token;
+};
+
+str_stream_t *str_stream_create(str_view_t delimiter) {
+  assert(delimiter.len > 0);
+
+  str_stream_t *S = (str_stream_t *) memory_malloc(sizeof(str_stream_t));
+
+  S->delimiter = str_view_copy(delimiter);
+  S->delimiter_len = delimiter.len;
+  S->carry = str_buf_create(0);
+  S->carry_emitted = false;
+  S->chunk = str_view_n("", 0);
+  S->index = 0;
+  S->finished = false;
+  S->token = str_view_n("", 0);
+
+  return S;
+}
+
+void str_stream_destroy(str_stream_t *S) {
+  assert(S);
+
+  memory_free(S->delimiter);
+  str_buf_destroy(S->carry);
+  memory_free(S);
+}
+
+void str_stream_feed(str_stream_t *S, const char *chunk, size_t n) {
+  assert(S);
+  assert(!S->finished);
+  assert(S->index == S->chunk.len);
+
+  S->chunk = str_view_n(chunk, n);
+  S->index = 0;
+}
+
+void str_stream_finish(str_stream_t *S) {
+  assert(S);
+  assert(S->index == S->chunk.len);
+
+  S->finished = true;
+}
+
+// Find the end of the token in the carry, reading on into the chunk.
+bool _str_stream_next_carried(str_stream_t *S) {
+  size_t dn = S->delimiter_len;
+  str_view_t delimiter = str_view_n(S->delimiter, dn);
+  str_view_t rest = str_view_splice(S->chunk, S->index, S->chunk.len);
+  size_t old_len = str_buf_len(S->carry);
+
+  // A delimiter that starts in the carry ends in the first dn - 1
+  // bytes of the chunk.
+  size_t head = rest.len < dn - 1 ? rest.len : dn - 1;
+  str_buf_append_n(S->carry, rest.data, head);
+  size_t window = old_len > dn - 1 ? old_len - (dn - 1) : 0;
+  str_view_t carried = str_buf_view(S->carry);
+  size_t j = window + str_view_find(str_view_splice(carried, window, carried.len), delimiter);
+  if (j < old_len) {
+    S->index += j + dn - old_len;
+    S->token = str_view_splice(carried, 0, j);
+    S->carry_emitted = true;
+    return true;
+  }
+
+  // Otherwise the delimiter lies within the chunk.
+  size_t i = str_view_find(rest, delimiter);
+  str_buf_t *carry = S->carry;
+  if (i < rest.len) {
+    str_buf_truncate(carry, old_len);
+    str_buf_append_view(carry, str_view_splice(rest, 0, i));
+    S->index += i + dn;
+    S->token = str_buf_view(carry);
+    S->carry_emitted = true;
+    return true;
+  }
+
+  str_buf_append_view(carry, str_view_splice(rest, head, rest.len));
+  S->index = S->chunk.len;
+  return false;
+}
+
+bool str_stream_next(str_stream_t *S) {
+  assert(S);
+
+  if (S->carry_emitted) {
+    str_buf_clear(S->carry);
+    S->carry_emitted = false;
+  }
+
+  if (S->index < S->chunk.len) {
+    if (str_buf_len(S->carry) > 0) {
+      return _str_stream_next_carried(S);
+    }
+
+    str_view_t rest = str_view_splice(S->chunk, S->index, S->chunk.len);
+    size_t i = str_view_find(rest, str_view_n(S->delimiter, S->delimiter_len));
+    if (i < rest.len) {
+      S->token = str_view_splice(rest, 0, i);
+      S->index += i + S->delimiter_len;
+      return true;
+    }
+    str_buf_append_view(S->carry, rest);
+    S->index = S->chunk.len;
+    return false;
+  }
+
+  // As with str_split, the end of the input ends the last token,
+  // unless it directly follows a delimiter.
+  if (S->finished && str_buf_len(S->carry) > 0) {
+    S->token = str_buf_view(S->carry);
+    S->carry_emitted = true;
+    return true;
+  }
+  return false;
+}
+
+str_view_t str_stream_token(str_stream_t *S) {
+  assert(S);
+  return S->token;
+}
+
+void str_stream_feed_each(str_stream_t *S, const char *chunk, size_t n, void (*emit)(str_view_t token, addr_t arg), addr_t arg) {
+  str_stream_feed(S, chunk, n);
+  while (str_stream_next(S)) {
+    emit(str_stream_token(S), arg);
+  }
+}
+
+void str_stream_finish_each(str_stream_t *S, void (*emit)(str_view_t token, addr_t arg), addr_t arg) {
+  str_stream_finish(S);
+  while (str_stream_next(S)) {
+    emit(str_stream_token(S), arg);
+  }
+}
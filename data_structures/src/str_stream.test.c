@@ -0,0 +1,110 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/list_extended.h"
+#include "../include/str.h"
+#include "../include/str_stream.h"
+
+// Feed s in random chunks, and check that the tokens are those of
+// str_split, including delimiters and tokens split across chunks.
+void test_str_stream_split() {
+  printf("str stream split\n");
+
+  str_t delimiters[] = {",", ">>", " >> ", "aba"};
+  char alphabet[] = "ab,> ";
+  char s[300];
+  size_t n;
+  list_t *L;
+  size_t num_tokens;
+  str_stream_t *S;
+  unsigned int seed = 7;
+  for (int round = 0; round < 4000; round++) {
+    seed = seed * 1103515245 + 12345;
+    n = (seed >> 8) % (sizeof(s) - 1);
+    for (int i = 0; i < n; i++) {
+      seed = seed * 1103515245 + 12345;
+      s[i] = alphabet[(seed >> 16) % 5];
+    }
+    s[n] = '\0';
+    str_t delimiter = delimiters[round % 4];
+    L = str_split(s, delimiter);
+
+    S = str_stream_create(str_view(delimiter));
+    num_tokens = 0;
+    size_t i = 0;
+    size_t chunk_len;
+    while (i < n) {
+      seed = seed * 1103515245 + 12345;
+      chunk_len = 1 + (seed >> 16) % 9;
+      if (chunk_len > n - i) {
+        chunk_len = n - i;
+      }
+      str_stream_feed(S, s + i, chunk_len);
+      while (str_stream_next(S)) {
+        assert(num_tokens < list_len(L));
+        assert(str_view_eq(str_stream_token(S), str_view(str_unwrap(list_get(L, num_tokens)))));
+        num_tokens++;
+      }
+      i += chunk_len;
+    }
+    str_stream_finish(S);
+    while (str_stream_next(S)) {
+      assert(str_view_eq(str_stream_token(S), str_view(str_unwrap(list_get(L, num_tokens)))));
+      num_tokens++;
+    }
+    assert(num_tokens == list_len(L));
+
+    str_stream_destroy(S);
+    list_total_destroy(L, str_destroy);
+  }
+}
+
+void _count_token(str_view_t token, addr_t arg) {
+  (*(size_t *) arg)++;
+}
+
+// Stream many chunks of short lines: only the stream itself and the
+// carry for the lines that span chunks should ever be allocated.
+void test_str_stream_constant_memory() {
+  printf("str stream constant memory\n");
+
+  char chunk[4096];
+  size_t n = 0;
+  while (n + 16 < sizeof(chunk)) {
+    n += snprintf(chunk + n, sizeof(chunk) - n, "line %lu\n", n);
+  }
+  // End mid-line, so that a line spans every pair of chunks.
+  n += snprintf(chunk + n, sizeof(chunk) - n, "li");
+
+  size_t num_lines = 0;
+  memory_count_reset();
+  str_stream_t *S = str_stream_create(str_view("\n"));
+  for (int i = 0; i < 2500; i++) {
+    str_stream_feed_each(S, chunk, n, _count_token, &num_lines);
+  }
+  str_stream_finish_each(S, _count_token, &num_lines);
+  assert(memory_count_report() < 1024);
+  str_stream_destroy(S);
+
+  size_t lines_per_chunk = 0;
+  for (int i = 0; i < n; i++) {
+    lines_per_chunk += chunk[i] == '\n';
+  }
+  assert(num_lines == 2500 * lines_per_chunk + 1);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_str_stream_split();
+  test_str_stream_constant_memory();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
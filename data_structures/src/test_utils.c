@@ -33,6 +33,22 @@ addr_t int_double(addr_t e) {
   return int_wrap(d);
 }
 
+bool int_is_even(addr_t e) {
+  return int_unwrap(e) % 2 == 0;
+}
+
+addr_t int_add(addr_t e1, addr_t e2) {
+  return int_wrap(int_unwrap(e1) + int_unwrap(e2));
+}
+
+addr_t int_increment(addr_t e) {
+  if (e == NULL) {
+    return int_wrap(1);
+  }
+  *((int *)e) = int_unwrap(e) + 1;
+  return e;
+}
+
 bool int_eq(addr_t e1, addr_t e2) {
   int i1 = *((int *) e1);
   int i2 = *((int *) e2);
@@ -68,6 +84,29 @@ void str_destroy(addr_t e) {
   memory_free(e);
 }
 
+void int_encode(addr_t e, str_buf_t *out) {
+  int i = int_unwrap(e);
+  str_buf_append_n(out, (const char *) &i, sizeof(int));
+}
+
+addr_t int_decode(str_view_t bytes) {
+  int i;
+  assert(bytes.len == sizeof(int));
+  memcpy(&i, bytes.data, sizeof(int));
+  return int_wrap(i);
+}
+
+void str_encode(addr_t e, str_buf_t *out) {
+  str_buf_append(out, (str_t) e);
+}
+
+addr_t str_decode(str_view_t bytes) {
+  return str_view_copy(bytes);
+}
+
+snapshot_codec_t INT_CODEC = {int_encode, int_decode, memory_free};
+snapshot_codec_t STR_CODEC = {str_encode, str_decode, memory_free};
+
 addr_t piece_create(char first, int second) {
   addr_t p = memory_malloc(sizeof(piece_t));
   ((piece_t *) p)->first = first;
@@ -0,0 +1,147 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "../include/test_utils.h"
+#include "../include/memory.h"
+#include "../include/typed.h"
+
+LIST_DEFINE(int_list, int)
+DICT_DEFINE(u64_double_dict, uint64_t, double, typed_hash_u64, typed_eq_u64)
+SET_DEFINE(int_set, int, typed_hash_int, typed_eq_int)
+
+// Every key hashes to the same slot, to exercise probing and removal.
+size_t _collide_hash(int k) {
+  return 0;
+}
+
+SET_DEFINE(collide_set, int, _collide_hash, typed_eq_int)
+
+void test_typed_list() {
+  printf("typed list\n");
+
+  int_list_t *L = int_list_create(0);
+  assert(int_list_len(L) == 0);
+
+  for (int i = 0; i < 100; i++) {
+    int_list_push(L, i);
+  }
+  assert(int_list_len(L) == 100);
+  for (int i = 0; i < 100; i++) {
+    assert(int_list_get(L, i) == i);
+  }
+
+  int_list_set(L, 5, -5);
+  assert(int_list_get(L, 5) == -5);
+
+  for (int i = 99; i >= 0; i--) {
+    if (i == 5) {
+      assert(int_list_pop(L) == -5);
+    } else {
+      assert(int_list_pop(L) == i);
+    }
+  }
+  assert(int_list_len(L) == 0);
+  int_list_destroy(L);
+
+  L = int_list_create(10);
+  assert(int_list_len(L) == 10);
+  assert(int_list_get(L, 9) == 0);
+  int_list_destroy(L);
+}
+
+void test_typed_dict() {
+  printf("typed dict\n");
+
+  u64_double_dict_t *D = u64_double_dict_create();
+  double v;
+
+  assert(u64_double_dict_get(D, 0, &v) == false);
+  assert(u64_double_dict_del(D, 0, &v) == false);
+
+  size_t N = 1000;
+  for (uint64_t i = 0; i < N; i++) {
+    u64_double_dict_set(D, i * 1024, i / 2.0);
+  }
+  assert(u64_double_dict_len(D) == N);
+
+  for (uint64_t i = 0; i < N; i++) {
+    assert(u64_double_dict_get(D, i * 1024, &v));
+    assert(v == i / 2.0);
+  }
+  assert(u64_double_dict_get(D, 1, &v) == false);
+
+  *u64_double_dict_get_or_insert(D, 0, 0) += 1;
+  assert(u64_double_dict_get(D, 0, &v));
+  assert(v == 1);
+  assert(*u64_double_dict_get_or_insert(D, 7, 3) == 3);
+  assert(u64_double_dict_len(D) == N + 1);
+
+  size_t cursor = 0;
+  size_t count = 0;
+  uint64_t k;
+  while (u64_double_dict_next(D, &cursor, &k, &v)) {
+    count++;
+  }
+  assert(count == N + 1);
+
+  for (uint64_t i = 0; i < N; i += 2) {
+    assert(u64_double_dict_del(D, i * 1024, &v));
+  }
+  assert(u64_double_dict_len(D) == N / 2 + 1);
+  for (uint64_t i = 0; i < N; i++) {
+    assert(u64_double_dict_get(D, i * 1024, &v) == (i % 2 == 1));
+  }
+
+  u64_double_dict_destroy(D);
+}
+
+void test_typed_set() {
+  printf("typed set\n");
+
+  int_set_t *S = int_set_create();
+  for (int i = 0; i < 100; i++) {
+    int_set_add(S, i % 50);
+  }
+  assert(int_set_len(S) == 50);
+  assert(int_set_includes(S, 49));
+  assert(!int_set_includes(S, 50));
+  assert(int_set_remove(S, 49));
+  assert(!int_set_remove(S, 49));
+  assert(!int_set_includes(S, 49));
+  int_set_destroy(S);
+
+  // Removing from the middle of a probe sequence
+  // must keep the rest of it reachable.
+  collide_set_t *C = collide_set_create();
+  for (int i = 0; i < 6; i++) {
+    collide_set_add(C, i);
+  }
+  assert(collide_set_remove(C, 2));
+  for (int i = 0; i < 6; i++) {
+    assert(collide_set_includes(C, i) == (i != 2));
+  }
+
+  size_t cursor = 0;
+  int e;
+  int sum = 0;
+  while (collide_set_next(C, &cursor, &e)) {
+    sum += e;
+  }
+  assert(sum == 0 + 1 + 3 + 4 + 5);
+  collide_set_destroy(C);
+}
+
+int main() {
+  memory_pointers_init();
+
+  test_typed_list();
+  test_typed_dict();
+  test_typed_set();
+
+  str_t usage = memory_pointers_report();
+  str_t expected = "->";
+  assert(strcmp(usage, expected) == 0);
+  memory_pointers_finish();
+
+  return 0;
+}
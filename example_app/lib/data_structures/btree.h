@@ -0,0 +1,55 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include "utils.h"
+#include "item.h"
+
+// B+-tree ordered map with O(log n) get/set/del and in-order iteration.
+// Keys are ordered by compare, the same way list_sort orders entries:
+// compare(k1, k2) > 0 if k1 comes before k2, e.g. int_compare.
+struct _impl_btree_t;
+typedef struct _impl_btree_t btree_t;
+
+btree_t *btree_create(int (*compare)(addr_t k1, addr_t k2));
+void btree_destroy(btree_t *T);
+void btree_total_destroy(btree_t *T, void (*key_destroy)(addr_t k), void (*value_destroy)(addr_t v));
+
+size_t btree_len(btree_t *T);
+// If k does not exist in T, return NULL.
+addr_t btree_get(btree_t *T, addr_t k);
+void btree_set(btree_t *T, addr_t k, addr_t v);
+// Return a new item holding the key and value that were removed,
+// for the caller to destroy.
+// If k does not exist in T, return NULL.
+item_t *btree_del(btree_t *T, addr_t k);
+
+// Cursor over the keys of a btree_t in increasing order,
+// walking the leaves in place without allocating.
+// T must not be modified while iterating.
+struct _btree_node;
+struct _impl_btree_iter_t {
+  struct _impl_btree_t *T;
+  struct _btree_node *leaf;
+  size_t index;
+  // If not NULL, stop before the first key >= hi.
+  addr_t hi;
+  addr_t key;
+  addr_t value;
+};
+typedef struct _impl_btree_iter_t btree_iter_t;
+
+// Iterate over every key.
+void btree_iter_init(btree_iter_t *It, btree_t *T);
+// Iterate over the keys in [lo, hi).
+void btree_range_init(btree_iter_t *It, btree_t *T, addr_t lo, addr_t hi);
+// Iterate from the first key >= k.
+void btree_lower_bound(btree_iter_t *It, btree_t *T, addr_t k);
+// Iterate from the first key > k.
+void btree_upper_bound(btree_iter_t *It, btree_t *T, addr_t k);
+
+// Advance to the next key. If there are none left, return false.
+bool btree_iter_next(btree_iter_t *It);
+addr_t btree_iter_key(btree_iter_t *It);
+addr_t btree_iter_value(btree_iter_t *It);
+
+#endif
@@ -6,6 +6,8 @@
 #include "list.h"
 
 // Hash-table implementation with O(1) get/set/del.
+// Dicts with only a few keys are stored as a flat array; larger ones
+// are hashed. The order of the keys is unspecified.
 struct _impl_dict_t;
 typedef struct _impl_dict_t dict_t;
 
@@ -17,10 +19,49 @@ addr_t dict_key_hash(dict_t *D);
 size_t dict_len(dict_t *D);
 // If k does not exist in D, return NULL.
 addr_t dict_get(dict_t *D, addr_t k);
+// Same as dict_get, for a hash of k already computed by the key_hash
+// of D, e.g. by a filter in front of D, so that k is only hashed once.
+addr_t dict_get_hashed(dict_t *D, addr_t k, size_t hash);
 list_t *dict_items(dict_t *D);
 
+// Cursor over the items of a dict_t that walks the table in place
+// without allocating. D must not be modified while iterating.
+struct _impl_dict_iter_t {
+  dict_t *D;
+  size_t bucket;
+  size_t index;
+  item_t *I;
+};
+typedef struct _impl_dict_iter_t dict_iter_t;
+
+void dict_iter_init(dict_iter_t *It, dict_t *D);
+// Advance to the next item. If there are none left, return false.
+bool dict_iter_next(dict_iter_t *It);
+item_t *dict_iter_item(dict_iter_t *It);
+addr_t dict_iter_key(dict_iter_t *It);
+addr_t dict_iter_value(dict_iter_t *It);
+
 void dict_set(dict_t *D, addr_t k, addr_t v);
+// Make room for n keys, so that setting up to n keys never resizes.
+void dict_reserve(dict_t *D, size_t n);
+// Both of the following hash k once and scan its bucket once,
+// and return a pointer to the value stored at k.
+// The pointer stays valid until k is deleted from D.
+// update receives the current value, or NULL if k does not exist in D,
+// and returns the value to store.
+addr_t *dict_upsert(dict_t *D, addr_t k, addr_t (*update)(addr_t v));
+// If k does not exist in D, first set it to v.
+addr_t *dict_get_or_insert(dict_t *D, addr_t k, addr_t v);
 // If k does not exist in D, return NULL.
 item_t *dict_del(dict_t *D, addr_t k);
 
+// Batch variants that size the table once for the whole batch
+// and hash each key exactly once.
+// values must be the same length as keys.
+void dict_set_many(dict_t *D, list_t *keys, list_t *values);
+// Return a list of the value at each key, NULL where a key does not exist.
+list_t *dict_get_many(dict_t *D, list_t *keys);
+// Return a list of the removed item for each key, NULL where a key does not exist.
+list_t *dict_del_many(dict_t *D, list_t *keys);
+
 #endif
@@ -0,0 +1,32 @@
+#ifndef FROZEN_DICT_H
+#define FROZEN_DICT_H
+
+#include "utils.h"
+#include "str.h"
+#include "dict.h"
+#include "snapshot.h"
+
+// Read-only hash table stored in a file, that is looked up directly
+// from its memory mapping: opening one does not read or build anything,
+// and processes that open the same file share its pages.
+// Keys and values are the bytes their codecs encode them to.
+struct _impl_frozen_dict_t;
+typedef struct _impl_frozen_dict_t frozen_dict_t;
+
+// Write the items of D to path, replacing any file there.
+// Only the encode functions of the codecs are used.
+// To replace a file that is in use, build to another path and rename it.
+// If path cannot be written to, return false.
+bool frozen_dict_build(str_t path, dict_t *D, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec);
+
+// If path cannot be mapped, or was not written by frozen_dict_build,
+// return NULL.
+frozen_dict_t *frozen_dict_open(str_t path);
+// Views into F are only valid until it is closed.
+void frozen_dict_close(frozen_dict_t *F);
+
+size_t frozen_dict_len(frozen_dict_t *F);
+// If key exists in F, point value at its bytes and return true.
+bool frozen_dict_get(frozen_dict_t *F, str_view_t key, str_view_t *value);
+
+#endif
@@ -30,6 +30,10 @@ size_t heap_len(heap_t *H);
 // Useful before doing a decrease-key operation.
 list_t *heap_iterator_create(heap_t *H);
 void heap_iterator_destroy(list_t *iterator);
+// Return a list of the items (key, value) of H, in no particular order.
+// O(N). Unlike heap_iterator_create, values need not be unique.
+// The items are owned by H.
+list_t *heap_items(heap_t *H);
 item_t *heap_peek_min(heap_t *H);
 
 void heap_insert(heap_t *H, addr_t k, addr_t v);
@@ -15,5 +15,7 @@ addr_t item_get_key(item_t *I);
 addr_t item_get_value(item_t *I);
 void item_set_key(item_t *I, addr_t k);
 void item_set_value(item_t *I, addr_t v);
+// Pointer to where the value is stored, for updating it in place.
+addr_t *item_value_slot(item_t *I);
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "utils.h"
+#include "str.h"
+
+// Read-only memory mapping of a whole file, so that it can be split
+// into lines or records as views into the mapped pages, without
+// reading it into a buffer or copying any line.
+struct _impl_mapped_file_t;
+typedef struct _impl_mapped_file_t mapped_file_t;
+
+// If sequential, hint that the file will be read from start to end,
+// so the kernel reads ahead and drops pages behind.
+// If path is not a regular file (e.g. a directory, a FIFO or a device),
+// or it cannot be opened or mapped, return NULL.
+// Files under /proc and /sys are regular but report a size of 0,
+// so they are mapped as empty files.
+mapped_file_t *mapped_file_open(str_t path, bool sequential);
+// Views into F are only valid until it is closed.
+void mapped_file_close(mapped_file_t *F);
+
+size_t mapped_file_len(mapped_file_t *F);
+str_view_t mapped_file_view(mapped_file_t *F);
+
+// Iterate over the lines of F, with the same lines as str_splitlines.
+void mapped_file_lines_init(str_split_iter_t *It, mapped_file_t *F);
+// Iterate over the records of F separated by delimiter.
+void mapped_file_records_init(str_split_iter_t *It, mapped_file_t *F, str_view_t delimiter);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SKIPLIST_CONN_H
+#define SKIPLIST_CONN_H
+
+#include <stdint.h>
+
+#include "utils.h"
+
+// Thread-safe ordered map, ordered by compare like btree_t:
+// compare(k1, k2) > 0 if k1 comes before k2, e.g. int_compare.
+// Reads never take a lock, so readers never block writers.
+// Writers only lock the nodes next to the key they change.
+struct _impl_skiplist_conn_t;
+typedef struct _impl_skiplist_conn_t skiplist_conn_t;
+
+skiplist_conn_t *skiplist_conn_create(int (*compare)(addr_t k1, addr_t k2));
+// Only call the destroy functions once no other thread uses SC.
+void skiplist_conn_destroy(skiplist_conn_t *SC);
+void skiplist_conn_total_destroy(skiplist_conn_t *SC, void (*key_destroy)(addr_t k), void (*value_destroy)(addr_t v));
+
+// Thread-safe read functions
+size_t skiplist_conn_len(skiplist_conn_t *SC);
+// If k does not exist in SC, return NULL.
+addr_t skiplist_conn_get(skiplist_conn_t *SC, addr_t k);
+
+// Thread-safe write functions
+// If k already exists, only its value is replaced,
+// and the caller keeps ownership of k.
+void skiplist_conn_set(skiplist_conn_t *SC, addr_t k, addr_t v);
+// Return the value that was removed.
+// If k does not exist in SC, return NULL.
+// Readers may still be looking at the removed key, so it stays owned
+// by SC until skiplist_conn_reclaim or skiplist_conn_total_destroy.
+addr_t skiplist_conn_del(skiplist_conn_t *SC, addr_t k);
+
+// Free the removed nodes that no other thread can still be looking at,
+// passing their keys to key_destroy if it is not NULL.
+// Thread-safe, and never waits for readers, so call it from time to
+// time, e.g. every few hundred deletes, to keep memory bounded.
+// Nodes removed while an operation or scan runs are freed by a call
+// after it ends, so a scan that never finishes holds them all.
+void skiplist_conn_reclaim(skiplist_conn_t *SC, void (*key_destroy)(addr_t k));
+
+// Cursor over the keys of a skiplist_conn_t in increasing order.
+// Iterating is thread-safe and never blocks: it sees every key that
+// is present for the whole scan, and may or may not see keys that
+// are set or removed during it.
+// A scan keeps the nodes removed during it from being reclaimed until
+// skiplist_conn_iter_next returns false, or skiplist_conn_iter_finish
+// is called to stop it early.
+struct _skiplist_node;
+struct _impl_skiplist_conn_iter_t {
+  struct _impl_skiplist_conn_t *SC;
+  struct _skiplist_node *node;
+  // If not NULL, stop before the first key >= hi.
+  addr_t hi;
+  addr_t key;
+  addr_t value;
+  uint64_t epoch;
+};
+typedef struct _impl_skiplist_conn_iter_t skiplist_conn_iter_t;
+
+// Iterate over every key.
+void skiplist_conn_iter_init(skiplist_conn_iter_t *It, skiplist_conn_t *SC);
+// Iterate over the keys in [lo, hi).
+void skiplist_conn_range_init(skiplist_conn_iter_t *It, skiplist_conn_t *SC, addr_t lo, addr_t hi);
+
+// Advance to the next key. If there are none left, return false.
+bool skiplist_conn_iter_next(skiplist_conn_iter_t *It);
+// Stop a scan before skiplist_conn_iter_next returns false.
+// Calling it after it returned false does nothing.
+void skiplist_conn_iter_finish(skiplist_conn_iter_t *It);
+addr_t skiplist_conn_iter_key(skiplist_conn_iter_t *It);
+addr_t skiplist_conn_iter_value(skiplist_conn_iter_t *It);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "utils.h"
+#include "str.h"
+#include "list.h"
+#include "dict.h"
+#include "set.h"
+#include "heap.h"
+
+/* Binary snapshots of the contents of a container, written to and
+ * read from a file descriptor, e.g. to save a large dict_t on exit
+ * and load it on restart instead of rebuilding it.
+ *
+ * A snapshot is a header holding the kind of container and its number
+ * of entries, followed by each entry (or each key and then its value)
+ * as its length and the bytes its codec encoded it to. Lengths are
+ * varints, so small entries cost one byte of framing.
+ *
+ * Saving and loading both go through a fixed-size buffer, so neither
+ * needs the whole snapshot in memory, and both work on pipes and
+ * sockets as well as files. Loading reads the snapshot once, and sizes
+ * the container for the count in the header before adding anything,
+ * as far as the bytes left in the file can hold that many entries.
+ */
+
+// How the entries (or keys, or values) of a container become bytes.
+struct _impl_snapshot_codec_t {
+  // Append the bytes of e to out.
+  void (*encode)(addr_t e, str_buf_t *out);
+  // Return a new entry from the bytes encode appended for it.
+  // bytes are only valid during the call.
+  addr_t (*decode)(str_view_t bytes);
+  // Free an entry returned by decode, if a load fails part way
+  // or the entry duplicates one already loaded.
+  // If NULL, such entries are leaked.
+  void (*destroy)(addr_t e);
+};
+typedef struct _impl_snapshot_codec_t snapshot_codec_t;
+
+// The save functions return false if fd could not be written to.
+// The load functions return NULL if fd could not be read from, or
+// does not hold a snapshot of the same kind of container, or holds
+// a corrupt one.
+// Both leave fd open, at the end of the snapshot. A load from a pipe
+// or socket may read past that end, and since it cannot seek back,
+// those bytes are lost: send one snapshot per connection, or nothing
+// after the last one.
+bool list_save(int fd, list_t *L, snapshot_codec_t *codec);
+list_t *list_load(int fd, snapshot_codec_t *codec);
+
+// If a snapshot holds a key (or set entry) more than once, the dict
+// keeps the first key with the last value, and the set keeps the
+// first entry.
+bool dict_save(int fd, dict_t *D, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec);
+dict_t *dict_load(
+  int fd,
+  bool (*key_eq) (addr_t k1, addr_t k2),
+  size_t (*key_hash) (addr_t k),
+  snapshot_codec_t *key_codec,
+  snapshot_codec_t *value_codec
+);
+
+bool set_save(int fd, set_t *S, snapshot_codec_t *codec);
+set_t *set_load(
+  int fd,
+  bool (*entry_eq) (addr_t e1, addr_t e2),
+  size_t (*hash) (addr_t e),
+  snapshot_codec_t *codec
+);
+
+// Only the keys and values of H are saved, not its shape,
+// so the loaded heap has the same items but not the same nodes.
+bool heap_save(int fd, heap_t *H, snapshot_codec_t *key_codec, snapshot_codec_t *value_codec);
+heap_t *heap_load(
+  int fd,
+  int (*compare)(addr_t k1, addr_t k2),
+  bool (*value_eq) (addr_t v1, addr_t v2),
+  size_t (*value_hash) (addr_t v),
+  snapshot_codec_t *key_codec,
+  snapshot_codec_t *value_codec
+);
+
+#endif
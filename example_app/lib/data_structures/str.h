@@ -16,4 +16,83 @@ list_t *str_splitlines(str_t s);
 str_t str_replace(str_t s, str_t sub1, str_t sub2);
 str_t str_strip(str_t s);
 
+// Growable string with a tracked length, to build a string in one pass
+// with amortized O(1) appends instead of rescanning it with strncat.
+struct _impl_str_buf_t;
+typedef struct _impl_str_buf_t str_buf_t;
+
+// Reserve room for capacity chars, not counting the \0.
+str_buf_t *str_buf_create(size_t capacity);
+void str_buf_destroy(str_buf_t *B);
+
+size_t str_buf_len(str_buf_t *B);
+void str_buf_append(str_buf_t *B, str_t s);
+void str_buf_append_n(str_buf_t *B, const char *s, size_t n);
+void str_buf_append_char(str_buf_t *B, char c);
+// Append the output of snprintf(format, ...).
+void str_buf_appendf(str_buf_t *B, const char *format, ...);
+// Append s, and free it, e.g. for the output of entry_string.
+void str_buf_append_owned(str_buf_t *B, str_t s);
+// Return the string built so far, and destroy B.
+str_t str_buf_finish(str_buf_t *B);
+
+// Borrowed slice of a string, which is not \0-terminated.
+// A view is only valid for as long as the string it points into.
+struct _impl_str_view_t {
+  const char *data;
+  size_t len;
+};
+typedef struct _impl_str_view_t str_view_t;
+
+str_view_t str_view(str_t s);
+str_view_t str_view_n(const char *s, size_t n);
+// Return a new str_t holding a copy of V.
+str_t str_view_copy(str_view_t V);
+bool str_view_eq(str_view_t V1, str_view_t V2);
+
+str_view_t str_view_splice(str_view_t V, size_t start, size_t end);
+str_view_t str_view_strip(str_view_t V);
+// Return the index of the first sub in V.
+// If sub is not found, return V.len.
+size_t str_view_find(str_view_t V, str_view_t sub);
+
+// Cursor over the tokens of a string split on a delimiter, with the
+// same tokens as str_split, that returns views and never allocates.
+struct _impl_str_split_iter_t {
+  str_view_t s;
+  str_view_t delimiter;
+  size_t index;
+  str_view_t token;
+};
+typedef struct _impl_str_split_iter_t str_split_iter_t;
+
+void str_split_iter_init(str_split_iter_t *It, str_view_t s, str_view_t delimiter);
+void str_splitlines_iter_init(str_split_iter_t *It, str_view_t s);
+// Advance to the next token. If there are none left, return false.
+bool str_split_iter_next(str_split_iter_t *It);
+str_view_t str_split_iter_token(str_split_iter_t *It);
+
+// str_buf_t carries its length, so the operations below never call
+// strlen on it. Each returns a new str_buf_t, and leaves B unchanged.
+str_buf_t *str_buf_from_str(str_t s);
+str_buf_t *str_buf_from_view(str_view_t V);
+size_t str_buf_capacity(str_buf_t *B);
+// Borrow the chars of B, which are always \0-terminated.
+// They are only valid until B is next changed.
+str_t str_buf_str(str_buf_t *B);
+str_view_t str_buf_view(str_buf_t *B);
+void str_buf_append_view(str_buf_t *B, str_view_t V);
+void str_buf_clear(str_buf_t *B);
+// Keep only the first len chars of B.
+void str_buf_truncate(str_buf_t *B, size_t len);
+
+str_buf_t *str_buf_splice(str_buf_t *B, size_t start, size_t end);
+// L is a list of str_buf_t.
+str_buf_t *str_buf_join(list_t *L, str_view_t delimiter);
+// Return a list of str_buf_t, with the same tokens as str_split.
+list_t *str_buf_split(str_buf_t *B, str_view_t delimiter);
+list_t *str_buf_splitlines(str_buf_t *B);
+str_buf_t *str_buf_replace(str_buf_t *B, str_view_t sub1, str_view_t sub2);
+str_buf_t *str_buf_strip(str_buf_t *B);
+
 #endif
@@ -0,0 +1,37 @@
+#ifndef STR_STREAM_H
+#define STR_STREAM_H
+
+#include "utils.h"
+#include "str.h"
+
+// Splits input that arrives in chunks, e.g. from read() on a pipe or
+// socket, into the same tokens str_split would give for the whole
+// input. Tokens are views: into the chunk when they lie within it,
+// and otherwise into a buffer that holds the part of a token that
+// spans chunks, so memory is bounded by the longest token rather
+// than the size of the input.
+struct _impl_str_stream_t;
+typedef struct _impl_str_stream_t str_stream_t;
+
+// The delimiter must not be empty.
+str_stream_t *str_stream_create(str_view_t delimiter);
+void str_stream_destroy(str_stream_t *S);
+
+// Give the next n bytes of input. The chunk must stay valid, and
+// str_stream_next must be called until it returns false, before
+// the next chunk is fed.
+void str_stream_feed(str_stream_t *S, const char *chunk, size_t n);
+// Mark the end of the input, so that the last token can be read.
+void str_stream_finish(str_stream_t *S);
+
+// Advance to the next token. If there are none left until more input
+// is fed, return false.
+bool str_stream_next(str_stream_t *S);
+// The view is only valid until the next call on S.
+str_view_t str_stream_token(str_stream_t *S);
+
+// Feed a chunk, or finish, and call emit on every token that completes.
+void str_stream_feed_each(str_stream_t *S, const char *chunk, size_t n, void (*emit)(str_view_t token, addr_t arg), addr_t arg);
+void str_stream_finish_each(str_stream_t *S, void (*emit)(str_view_t token, addr_t arg), addr_t arg);
+
+#endif